@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "AudioVoicePool.h"
+#include "LightsOutPerf.h"
+
+static TAutoConsoleVariable<int32> CVarAudioPoolPrewarm(
+    TEXT("LightsOut.Audio.PrewarmVoices"),
+    16,
+    TEXT("Number of audio components created when a world's voice pool is first used."));
+
+static TAutoConsoleVariable<int32> CVarAudioPoolMaxVoices(
+    TEXT("LightsOut.Audio.MaxVoices"),
+    32,
+    TEXT("Most audio components a world's voice pool will ever create, after that voices are stolen."));
+
+static TAutoConsoleVariable<int32> CVarAudioPoolMaxVoicesPerSound(
+    TEXT("LightsOut.Audio.MaxVoicesPerSound"),
+    4,
+    TEXT("Most voices a single sound can play at once, the oldest one is stolen past that."));
+
+UAudioComponent *FAudioVoicePool::PlaySoundAttached(USoundBase *Sound, USceneComponent *AttachToComponent)
+{
+    LIGHTSOUT_SCOPE(PlaySound);
+    
+    if(Sound == nullptr || AttachToComponent == nullptr) { return nullptr; }
+
+    UWorld *World = AttachToComponent->GetWorld();
+    if(World == nullptr) { return nullptr; }
+
+    return Get(World)->Play(Sound, AttachToComponent);
+}
+
+FAudioVoicePool *FAudioVoicePool::Get(UWorld *World)
+{
+    return TLightsOutPerWorld<FAudioVoicePool>::Get(World);
+}
+
+FAudioVoicePool::FAudioVoicePool(UWorld *InWorld)
+    : World(InWorld)
+{
+    const int32 Prewarm = FMath::Min(CVarAudioPoolPrewarm.GetValueOnGameThread(), CVarAudioPoolMaxVoices.GetValueOnGameThread());
+    Voices.Reserve(Prewarm);
+    VoiceSounds.Reserve(Prewarm);
+    VoiceStartTimes.Reserve(Prewarm);
+    for(int32 Index = 0; Index < Prewarm; Index++)
+    {
+        CreateVoice();
+    }
+}
+
+FAudioVoicePool::~FAudioVoicePool()
+{
+    DEC_MEMORY_STAT_BY(STAT_LightsOut_AudioVoiceMemory, Voices.Num() * sizeof(UAudioComponent));
+}
+
+UAudioComponent *FAudioVoicePool::Play(USoundBase *Sound, USceneComponent *AttachToComponent)
+{
+    const int32 VoiceIndex = FindVoice(Sound);
+    if(VoiceIndex == INDEX_NONE) { return nullptr; }
+
+    UAudioComponent *Voice = Voices[VoiceIndex];
+    Voice->Stop();
+    Voice->AttachTo(AttachToComponent, NAME_None, EAttachLocation::SnapToTarget);
+    Voice->SetSound(Sound);
+    Voice->Play();
+
+    VoiceSounds[VoiceIndex] = Sound;
+    VoiceStartTimes[VoiceIndex] = World->GetAudioTimeSeconds();
+    return Voice;
+}
+
+int32 FAudioVoicePool::CreateVoice()
+{
+    // The voices belong to the world settings so they outlive whatever actor they are attached to.
+    UAudioComponent *Voice = NewObject<UAudioComponent>(World->GetWorldSettings());
+    Voice->bAutoActivate = false;
+    Voice->bAutoDestroy = false;
+    Voice->RegisterComponentWithWorld(World);
+    INC_MEMORY_STAT_BY(STAT_LightsOut_AudioVoiceMemory, sizeof(UAudioComponent));
+
+    VoiceSounds.Add(nullptr);
+    VoiceStartTimes.Add(0.0f);
+    return Voices.Add(Voice);
+}
+
+int32 FAudioVoicePool::FindVoice(USoundBase *Sound)
+{
+    int32 FreeVoice = INDEX_NONE;
+    int32 OldestVoice = INDEX_NONE;
+    int32 OldestSameSound = INDEX_NONE;
+    int32 SameSoundCount = 0;
+
+    for(int32 Index = 0; Index < Voices.Num(); Index++)
+    {
+        UAudioComponent *Voice = Voices[Index];
+        if(Voice == nullptr || Voice->IsPendingKill())
+        {
+            continue;
+        }
+        if(!Voice->IsPlaying())
+        {
+            if(FreeVoice == INDEX_NONE)
+            {
+                FreeVoice = Index;
+            }
+            continue;
+        }
+
+        if(OldestVoice == INDEX_NONE || VoiceStartTimes[Index] < VoiceStartTimes[OldestVoice])
+        {
+            OldestVoice = Index;
+        }
+        if(VoiceSounds[Index] == Sound)
+        {
+            SameSoundCount++;
+            if(OldestSameSound == INDEX_NONE || VoiceStartTimes[Index] < VoiceStartTimes[OldestSameSound])
+            {
+                OldestSameSound = Index;
+            }
+        }
+    }
+
+    // A sound over its own limit replaces its oldest voice rather than taking another one.
+    if(SameSoundCount >= FMath::Max(1, CVarAudioPoolMaxVoicesPerSound.GetValueOnGameThread()))
+    {
+        return OldestSameSound;
+    }
+    if(FreeVoice != INDEX_NONE)
+    {
+        return FreeVoice;
+    }
+    if(Voices.Num() < CVarAudioPoolMaxVoices.GetValueOnGameThread())
+    {
+        return CreateVoice();
+    }
+    return OldestVoice;
+}
+
+void FAudioVoicePool::AddReferencedObjects(FReferenceCollector &Collector)
+{
+    Collector.AddReferencedObjects(Voices);
+    Collector.AddReferencedObjects(VoiceSounds);
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LightsOutPerWorld.h"
+
+/**
+ * Per-world pool of audio components that gameplay sounds are played through. Components are
+ * created up front and reused, so playing a sound does not allocate anything or leave garbage for
+ * the GC. Each sound is limited to a number of concurrent voices, and when a sound is over its
+ * limit or the pool is full the oldest voice is stolen.
+ */
+class LIGHTSOUT_API FAudioVoicePool : public FGCObject
+{
+    public:
+
+        // Plays the sound attached to the component and returns the voice playing it, or nullptr
+        // if there was no sound.
+        static class UAudioComponent *PlaySoundAttached(class USoundBase *Sound, USceneComponent *AttachToComponent);
+
+        // Returns the pool for the world, creating and pre-warming it if needed.
+        static FAudioVoicePool *Get(UWorld *World);
+
+        class UAudioComponent *Play(class USoundBase *Sound, USceneComponent *AttachToComponent);
+
+        virtual ~FAudioVoicePool();
+
+        // FGCObject interface
+        virtual void AddReferencedObjects(FReferenceCollector &Collector) override;
+
+    private:
+
+        friend class TLightsOutPerWorld<FAudioVoicePool>;
+
+        explicit FAudioVoicePool(UWorld *InWorld);
+
+        int32 CreateVoice();
+        int32 FindVoice(class USoundBase *Sound);
+
+    private:
+
+        UWorld *World;
+
+        // Parallel arrays, one entry per voice.
+        TArray<class UAudioComponent*> Voices;
+        TArray<class USoundBase*> VoiceSounds;
+        TArray<float> VoiceStartTimes;
+};
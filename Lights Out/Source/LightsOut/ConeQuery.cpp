@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "ConeQuery.h"
+
+FPackedSpheres::FPackedSpheres()
+    : Count(0)
+{
+}
+
+void FPackedSpheres::Reset()
+{
+    CenterX.Reset();
+    CenterY.Reset();
+    CenterZ.Reset();
+    Radii.Reset();
+    Count = 0;
+}
+
+void FPackedSpheres::Reserve(int32 Number)
+{
+    const int32 Padded = Align(Number, 4);
+    CenterX.Reserve(Padded);
+    CenterY.Reserve(Padded);
+    CenterZ.Reserve(Padded);
+    Radii.Reserve(Padded);
+}
+
+int32 FPackedSpheres::Add(const FVector &Center, float Radius)
+{
+    // Grows the arrays a whole group of four at a time, the unused lanes are masked out when culling.
+    if(Count == CenterX.Num())
+    {
+        CenterX.AddZeroed(4);
+        CenterY.AddZeroed(4);
+        CenterZ.AddZeroed(4);
+        Radii.AddZeroed(4);
+    }
+
+    CenterX[Count] = Center.X;
+    CenterY[Count] = Center.Y;
+    CenterZ[Count] = Center.Z;
+    Radii[Count] = Radius;
+    return Count++;
+}
+
+void FPackedSpheres::CullToCone(const FConeQuery &Cone, TArray<int32> &OutIndices) const
+{
+    OutIndices.Reset();
+
+    const float HalfAngle = FMath::DegreesToRadians(FMath::Clamp(Cone.HalfAngle, 0.0f, 89.0f));
+    const float Cos = FMath::Cos(HalfAngle);
+
+    const VectorRegister Zero = VectorZero();
+    const VectorRegister ApexX = VectorSetFloat1(Cone.Apex.X);
+    const VectorRegister ApexY = VectorSetFloat1(Cone.Apex.Y);
+    const VectorRegister ApexZ = VectorSetFloat1(Cone.Apex.Z);
+    const VectorRegister DirectionX = VectorSetFloat1(Cone.Direction.X);
+    const VectorRegister DirectionY = VectorSetFloat1(Cone.Direction.Y);
+    const VectorRegister DirectionZ = VectorSetFloat1(Cone.Direction.Z);
+    const VectorRegister Range = VectorSetFloat1(Cone.Range);
+    const VectorRegister SinAngle = VectorSetFloat1(FMath::Sin(HalfAngle));
+    const VectorRegister CosSquared = VectorSetFloat1(Cos * Cos);
+
+    for(int32 Index = 0; Index < Count; Index += 4)
+    {
+        const VectorRegister OffsetX = VectorSubtract(VectorLoad(&CenterX[Index]), ApexX);
+        const VectorRegister OffsetY = VectorSubtract(VectorLoad(&CenterY[Index]), ApexY);
+        const VectorRegister OffsetZ = VectorSubtract(VectorLoad(&CenterZ[Index]), ApexZ);
+        const VectorRegister Radius = VectorLoad(&Radii[Index]);
+
+        // Distance along the beam and squared distance from the apex.
+        const VectorRegister Along = VectorMultiplyAdd(OffsetZ, DirectionZ,
+                                     VectorMultiplyAdd(OffsetY, DirectionY, VectorMultiply(OffsetX, DirectionX)));
+        const VectorRegister DistanceSquared = VectorMultiplyAdd(OffsetZ, OffsetZ,
+                                               VectorMultiplyAdd(OffsetY, OffsetY, VectorMultiply(OffsetX, OffsetX)));
+        const VectorRegister PerpendicularSquared = VectorMax(VectorSubtract(DistanceSquared, VectorMultiply(Along, Along)), Zero);
+
+        // The sphere has to be within reach of the light.
+        const VectorRegister Reach = VectorAdd(Range, Radius);
+        const VectorRegister InRange = VectorCompareGE(VectorMultiply(Reach, Reach), DistanceSquared);
+
+        // Distance from the center to the cone's surface is Perpendicular * Cos - Along * Sin, the sphere
+        // touches the cone when that is no more than its radius. Compared squared to stay off the sqrt.
+        const VectorRegister Allowance = VectorMultiplyAdd(Along, SinAngle, Radius);
+        const VectorRegister InFront = VectorCompareGE(Allowance, Zero);
+        const VectorRegister InCone = VectorCompareGE(VectorMultiply(Allowance, Allowance),
+                                                      VectorMultiply(PerpendicularSquared, CosSquared));
+
+        const int32 Mask = VectorMaskBits(VectorBitwiseAnd(InRange, VectorBitwiseAnd(InFront, InCone)));
+        if(Mask == 0) { continue; }
+
+        const int32 Lanes = FMath::Min(4, Count - Index);
+        for(int32 Lane = 0; Lane < Lanes; Lane++)
+        {
+            if(Mask & (1 << Lane))
+            {
+                OutIndices.Add(Index + Lane);
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Describes a light cone: the apex, the unit direction of the beam, how far it reaches and the
+// half angle (in degrees) of the outer cone.
+struct FConeQuery
+{
+    FConeQuery(const FVector &InApex, const FVector &InDirection, float InRange, float InHalfAngle)
+        : Apex(InApex)
+        , Direction(InDirection)
+        , Range(InRange)
+        , HalfAngle(InHalfAngle)
+    {
+    }
+
+    FVector Apex;
+    FVector Direction;
+    float Range;
+    float HalfAngle;
+};
+
+// Bounding spheres packed as a structure of arrays so four of them can be tested against a cone
+// in a single pass of the vector unit.
+class LIGHTSOUT_API FPackedSpheres
+{
+    public:
+
+        FPackedSpheres();
+
+        void Reset();
+        void Reserve(int32 Number);
+        int32 Add(const FVector &Center, float Radius);
+        int32 Num() const { return Count; }
+
+        // Writes the index of every sphere that touches the cone into OutIndices.
+        void CullToCone(const FConeQuery &Cone, TArray<int32> &OutIndices) const;
+
+    private:
+
+        // Each array is padded to a multiple of four so the kernel never reads past the end.
+        TArray<float> CenterX;
+        TArray<float> CenterY;
+        TArray<float> CenterZ;
+        TArray<float> Radii;
+        int32 Count;
+};
@@ -3,47 +3,174 @@
 #include "LightsOut.h"
 #include "FirstRoom.h"
 #include "SoundGem.h"
+#include "PuzzleDefinition.h"
+#include "LightsOutCore/PuzzleModel.h"
 #include "LightsOutCharacter.h"
 #include "Flashlight.h"
 #include "Sound/SoundCue.h"
+#include "AudioVoicePool.h"
+#include "LightsOutPerf.h"
+#include "LightsOutGameInstance.h"
+#include "LightsOutCheckpoint.h"
+#include "UnrealNetwork.h"
 
-void AFirstRoom::BeginPlay()
+static const uint32 PuzzleGemMask = 0xFFFF;
+static const int32 PuzzleGoalShift = 16;
+static const uint32 PuzzleSolvedBit = 0x80000000;
+
+AFirstRoom::AFirstRoom()
 {
-	Super::BeginPlay();
+    // The room only has something to send when the puzzle changes, so it stays dormant in between.
+    bReplicates = true;
+    NetDormancy = DORM_DormantAll;
+}
+
+void AFirstRoom::PostLoad()
+{
+    Super::PostLoad();
     
+    ULightsOutGameInstance::MigrateReference(DoorSound_DEPRECATED, DoorSoundAsset);
+    ULightsOutGameInstance::MigrateReference(FailSound_DEPRECATED, FailSoundAsset);
+}
+
+void AFirstRoom::BeginPlay()
+{
+    // Reset before the base class, which may restore a checkpoint over it.
 	CurrentGoal = 0;
     IsSolved = false;
     HasFailed = false;
+	Super::BeginPlay();
+    
+    ULightsOutGameInstance::RequestAsyncLoad(this, { DoorSoundAsset.ToStringReference(), FailSoundAsset.ToStringReference() });
+}
+
+void AFirstRoom::GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+    
+    DOREPLIFETIME(AFirstRoom, PuzzleBits);
+}
+
+void AFirstRoom::UpdatePuzzleBits()
+{
+    if(Role < ROLE_Authority) { return; }
+    
+    uint32 Bits = (uint32(FMath::Clamp(CurrentGoal, 0, 255)) << PuzzleGoalShift) | (IsSolved ? PuzzleSolvedBit : 0);
+    for(int32 Index = 0; Index < FMath::Min(SoundGems.Num(), 16); Index++)
+    {
+        if(SoundGems[Index] && SoundGems[Index]->IsSolved())
+        {
+            Bits |= 1 << Index;
+        }
+    }
+    
+    if(Bits != PuzzleBits)
+    {
+        const bool HasJustSolved = (Bits & PuzzleSolvedBit) && !(PuzzleBits & PuzzleSolvedBit);
+        PuzzleBits = Bits;
+        FlushNetDormancy();
+        UpdateStreaming(GetProgress(), IsSolved);
+        
+        // Every solved room is a checkpoint, taken once the last gem is lit.
+        if(HasJustSolved)
+        {
+            ULightsOutGameInstance::SaveCheckpoint(this);
+        }
+    }
+}
+
+float AFirstRoom::GetProgress() const
+{
+    const int32 Length = Definition ? Definition->GetMaxDepth() : SoundGems.Num();
+    return Length > 0 ? FMath::Min(float(CurrentGoal) / Length, 1.0f) : 0.0f;
 }
 
-void AFirstRoom::Tick(float DeltaTime)
+// Brings the gems and door in line with the server's puzzle.
+void AFirstRoom::OnRep_PuzzleBits()
 {
-	Super::Tick(DeltaTime);
+    CurrentGoal = (PuzzleBits >> PuzzleGoalShift) & 0xFF;
+    for(int32 Index = 0; Index < FMath::Min(SoundGems.Num(), 16); Index++)
+    {
+        if(SoundGems[Index])
+        {
+            SoundGems[Index]->SetShining((PuzzleBits & PuzzleGemMask & (1 << Index)) != 0);
+        }
+    }
+    
+    if((PuzzleBits & PuzzleSolvedBit) && !IsSolved)
+    {
+        IsSolved = true;
+        SolvedAudioComponent = PlaySound(DoorSoundAsset);
+        if(Door)
+        {
+            Door->Destroy();
+        }
+    }
+    
+    // Clients stream their own levels, following the same progress as the server.
+    UpdateStreaming(GetProgress(), IsSolved);
 }
 
 //Correct Sequence is in Blue, Green, Purple, Red
 bool AFirstRoom::CheckSequence(ASoundGem *LitGem)
 {
+    LIGHTSOUT_SCOPE(CheckSequence);
+    
     if(IsSolved)
     {
         return true;
     }
     
-	if (LitGem->GetLightColor() == SoundGems[CurrentGoal]->GetLightColor())
+    if(Definition)
     {
-		CurrentGoal++;
-        HasFailed = false;
-		if (CurrentGoal >= SoundGems.Num())
-		{
-			OnCompletePuzzle();
-		}
-        return true;
-	}
-	else
+        return CheckDefinition(LitGem);
+    }
+    
+    const bool Matches = LitGem->GetLightColor() == SoundGems[CurrentGoal]->GetLightColor();
+    const LightsOutCore::SequenceStep Step = LightsOutCore::AdvanceSequence(CurrentGoal, Matches, SoundGems.Num());
+    if(Step.Failed)
     {
 		OnFailPuzzle();
         return false;
 	}
+    
+    CurrentGoal = Step.NextGoal;
+    HasFailed = false;
+    if(Step.Complete)
+    {
+        OnCompletePuzzle();
+    }
+    return true;
+}
+
+// Evaluates the lit gem against the room's compiled puzzle definition.
+bool AFirstRoom::CheckDefinition(ASoundGem *LitGem)
+{
+    const uint16 Transition = AdvancePuzzle(LitGem->GetGemId());
+    const int32 NextState = PuzzleState;
+    
+    if(Transition & LightsOutCore::PuzzleFailedFlag)
+    {
+        OnFailPuzzle();
+        
+        // The gem that broke the sequence may have started a new attempt.
+        PuzzleState = NextState;
+        if(NextState == 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        HasFailed = false;
+    }
+    
+    CurrentGoal = Definition->GetDepth(NextState);
+    if(Transition & LightsOutCore::PuzzleCompleteFlag)
+    {
+        OnCompletePuzzle();
+    }
+    return true;
 }
 
 void AFirstRoom::SpawnPuzzle()
@@ -57,7 +184,7 @@ void AFirstRoom::OnCompletePuzzle()
     
     SoundGems[0]->PlayWinAudio();
     IsSolved = true;
-	SolvedAudioComponent = PlaySound(DoorSound);
+	SolvedAudioComponent = PlaySound(DoorSoundAsset);
     if(Door)
     {
          Door->Destroy();   
@@ -73,15 +200,53 @@ void AFirstRoom::OnFailPuzzle()
 	Super::OnFailPuzzle();
     
 	CurrentGoal = 0;
-	for (int i = 0; i < SoundGems.Num(); i++)
+	PuzzleState = 0;
     {
-		SoundGems[i]->Reset();
-	}
+        LIGHTSOUT_SCOPE(ResetPuzzle);
+        for (int i = 0; i < SoundGems.Num(); i++)
+        {
+            SoundGems[i]->Reset();
+        }
+    }
     if(!HasFailed)
     {
         SoundGems[0]->PlayFailAudio();
         HasFailed = true;
     }
+    UpdatePuzzleBits();
+}
+
+void AFirstRoom::SaveCheckpoint(FPuzzleCheckpoint &Checkpoint) const
+{
+    Super::SaveCheckpoint(Checkpoint);
+    
+    Checkpoint.PuzzleBits = PuzzleBits;
+}
+
+// Sets the room straight to the saved state, without the sounds or fades of playing up to it.
+void AFirstRoom::RestoreCheckpoint(const FPuzzleCheckpoint &Checkpoint)
+{
+    Super::RestoreCheckpoint(Checkpoint);
+    
+    PuzzleBits = Checkpoint.PuzzleBits;
+    CurrentGoal = (PuzzleBits >> PuzzleGoalShift) & 0xFF;
+    IsSolved = (PuzzleBits & PuzzleSolvedBit) != 0;
+    HasFailed = false;
+    for(int32 Index = 0; Index < SoundGems.Num(); Index++)
+    {
+        if(SoundGems[Index])
+        {
+            SoundGems[Index]->RestoreShining(Index < 16 && (PuzzleBits & (1 << Index)) != 0);
+        }
+    }
+    if(IsSolved && Door)
+    {
+        Door->Destroy();
+        Door = nullptr;
+    }
+    
+    FlushNetDormancy();
+    UpdateStreaming(GetProgress(), IsSolved);
 }
 
 bool AFirstRoom::CheckIsSolved()
@@ -89,12 +254,13 @@ bool AFirstRoom::CheckIsSolved()
     return false;
 }
 
-UAudioComponent *AFirstRoom::PlaySound(USoundCue *Sound)
+UAudioComponent *AFirstRoom::PlaySound(const TAssetPtr<USoundCue> &SoundAsset)
 {
+	USoundCue *Sound = ULightsOutGameInstance::Resolve(this, SoundAsset);
 	UAudioComponent *AC = nullptr;
 	if (Sound)
 	{
-		AC = UGameplayStatics::SpawnSoundAttached(Sound, RootComponent);
+		AC = FAudioVoicePool::PlaySoundAttached(Sound, RootComponent);
 	}
 	return AC;
 }
@@ -14,26 +14,46 @@ class LIGHTSOUT_API AFirstRoom : public APuzzleManager
 	GENERATED_BODY()
 	
     public:
+        AFirstRoom();
+        virtual void PostLoad() override;
         virtual void BeginPlay() override;
-        virtual void Tick(float DeltaTime) override;
+        virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const override;
         virtual void SpawnPuzzle() override;
         virtual void OnCompletePuzzle() override;
         virtual void OnFailPuzzle() override;
         virtual bool CheckIsSolved() override;
-		class UAudioComponent *PlaySound(class USoundCue *Sound);
+        virtual void SaveCheckpoint(struct FPuzzleCheckpoint &Checkpoint) const override;
+        virtual void RestoreCheckpoint(const struct FPuzzleCheckpoint &Checkpoint) override;
+		class UAudioComponent *PlaySound(const TAssetPtr<class USoundCue> &SoundAsset);
 
     public:
         bool CheckSequence(class ASoundGem *LitGem);
+        // Packs the gems and progress into PuzzleBits, waking the room for replication if they changed.
+        void UpdatePuzzleBits();
+    
+    protected:
+        bool CheckDefinition(class ASoundGem *LitGem);
+        // How far through the puzzle the room is, from 0 to 1.
+        float GetProgress() const;
+    
+        UFUNCTION()
+        void OnRep_PuzzleBits();
     
     protected:
 		UPROPERTY(Transient)
 		class UAudioComponent *SolvedAudioComponent;
 
 		UPROPERTY(EditAnywhere, Category = Sound)
-		class USoundCue *DoorSound;
+		TAssetPtr<class USoundCue> DoorSoundAsset;
     
         UPROPERTY(EditAnywhere, Category = Sound)
-        class USoundCue *FailSound;
+        TAssetPtr<class USoundCue> FailSoundAsset;
+
+        // Hard references from before the sounds were loaded softly, moved over in PostLoad().
+        UPROPERTY()
+        class USoundCue *DoorSound_DEPRECATED;
+        UPROPERTY()
+        class USoundCue *FailSound_DEPRECATED;
 
         UPROPERTY(EditAnywhere)
         TArray<class ASoundGem*> SoundGems;
@@ -48,4 +68,9 @@ class LIGHTSOUT_API AFirstRoom : public APuzzleManager
         int CurrentGoal;
         bool IsSolved;
         bool HasFailed;
+    
+        // Everything clients need about the puzzle in one word: which gems are lit in the low 16 bits,
+        // the current goal in the next 8 and whether the room is solved in the top bit.
+        UPROPERTY(ReplicatedUsing = OnRep_PuzzleBits)
+        uint32 PuzzleBits;
 };
@@ -3,12 +3,40 @@
 #include "LightsOut.h"
 #include "Flashlight.h"
 #include "Sound/SoundCue.h"
+#include "AudioVoicePool.h"
 #include "HittableObject.h"
+#include "HittableRegistry.h"
+#include "LightExposureGrid.h"
+#include "LightsOutPerf.h"
+#include "LightsOutGameInstance.h"
 #include "LightsOutCharacter.h"
+#include "GameFramework/GameState.h"
+#include "UnrealNetwork.h"
+
+static TAutoConsoleVariable<int32> CVarFlashlightAsyncTrace(
+    TEXT("LightsOut.Flashlight.AsyncTrace"),
+    0,
+    TEXT("0: the beam's occlusion traces block the game thread and are used in the same frame.\n")
+    TEXT("1: the traces are issued asynchronously and their results are used on the next frame."));
+
+static TAutoConsoleVariable<int32> CVarFlashlightRaysPerFrame(
+    TEXT("LightsOut.Flashlight.RaysPerFrame"),
+    16,
+    TEXT("Occlusion rays each flashlight traces per frame, shared between the objects in its beam."));
+
+static TAutoConsoleVariable<int32> CVarFlashlightSamplesPerObject(
+    TEXT("LightsOut.Flashlight.SamplesPerObject"),
+    8,
+    TEXT("Points across an object the beam's rays cycle through, an object gets at most this many rays a frame."));
+
+// Turning by the golden angle between samples spreads any run of them evenly around the disc.
+static const float BeamGoldenAngle = PI * (3.0f - 2.2360679775f);
+static const uint8 BeamRayPending = 0xFF;
 
 AFlashlight::AFlashlight()
 {
     PrimaryActorTick.bCanEverTick = true;
+    bReplicates = true;
     
     // Creates a skeletal component for the flashlight and attaches it to this Actor, making it the root component.
     FlashlightMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("FlashlightMesh"));
@@ -19,136 +47,568 @@ AFlashlight::AFlashlight()
     SpotLightComponent->AttachTo(RootComponent);
 }
 
+void AFlashlight::PostLoad()
+{
+    Super::PostLoad();
+    
+    ULightsOutGameInstance::MigrateReference(ToggleOnSound_DEPRECATED, ToggleOnSoundAsset);
+    ULightsOutGameInstance::MigrateReference(ToggleOffSound_DEPRECATED, ToggleOffSoundAsset);
+}
+
 void AFlashlight::BeginPlay()
 {
     Super::BeginPlay();
     
+    AsyncTraceDelegate.BindUObject(this, &AFlashlight::OnAsyncTraceDone);
+    UpdateBeamQueryParams();
+    ULightsOutGameInstance::RequestAsyncLoad(this, { ToggleOnSoundAsset.ToStringReference(), ToggleOffSoundAsset.ToStringReference() });
+    
     Initialize();
+    FLightExposureGrid::Get(GetWorld())->Register(SpotLightComponent);
+}
+
+void AFlashlight::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    ClearBeamContacts();
+    GetWorldTimerManager().ClearTimer(DepletionTimer);
+    LIGHTSOUT_TRACK_MEMORY(STAT_LightsOut_BeamMemory, ReportedBeamMemory, 0);
+    LIGHTSOUT_TRACK_MEMORY(STAT_LightsOut_LightCurveMemory, ReportedCurveMemory, 0);
+    
+    FLightExposureGrid *ExposureGrid = FLightExposureGrid::Find(GetWorld());
+    if(ExposureGrid)
+    {
+        ExposureGrid->Unregister(SpotLightComponent);
+    }
+    
+    Super::EndPlay(EndPlayReason);
 }
 
 void AFlashlight::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
     
-    // If the flashlight is on the battery life is decreased, the raycast is used to try and intersect
-    // with a hittable object, and the light variables are lerpec based on the direction.
+    // If the flashlight is on the raycast is used to try and intersect with a hittable object, and the
+    // light variables are lerpec based on the direction. The battery is not touched here, it drains
+    // along its anchor and runs out through a timer. This only ticks on the server, clients apply the
+    // state it replicates.
     if(IsOn)
     {
-        BatteryLife -= DeltaTime * ConsumptionRate;
-        CastLight();
+        CastLight(DeltaTime);
+        UpdateBeamContacts(DeltaTime);
         LerpLight(DeltaTime * LerpDirection);
     }
-    
-    // If the battery is dead and the light is on, this will turn it off.
-    if(BatteryLife <= 0 && IsOn)
-    {
-        ToggleLight();
-        UGameplayStatics::SetGamePaused(GetWorld(),true);
-    }
 }
 
 void AFlashlight::Initialize()
 {
+    SpotLightComponent->SetLightColor(LightColor);
+    BuildLightCurve();
+    LerpDirection = 0;
+    
+    if(Role < ROLE_Authority)
+    {
+        // Clients start from whatever the server has already replicated.
+        SetActorTickEnabled(false);
+        OnRep_Focus();
+        BatteryDrainRate = EvaluateDrainRate();
+        return;
+    }
+    
     // Initializes the variables based on the initial percentage and turns on the flashlight.
     IsOn = true;
-    SpotLightComponent->SetLightColor(LightColor);
     CurrentPercentage = InitialPercentage;
-    LerpConsumptionRate(CurrentPercentage);
-    LerpRadius(CurrentPercentage);
-    LerpIntensity(CurrentPercentage);
-    LerpRange(CurrentPercentage);
+    Focus = uint8(FMath::RoundToInt(CurrentPercentage * 2.55f));
+    EvaluateLightCurve(CurrentPercentage);
+    BatteryAnchor.ServerTime = GetServerTime();
+    BatteryAnchor.Life = InitialBatteryLife;
     
-    LerpDirection = 0;
+    ToggleLight();
+}
+
+void AFlashlight::GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+    
+    DOREPLIFETIME(AFlashlight, IsOn);
+    DOREPLIFETIME(AFlashlight, Focus);
+    DOREPLIFETIME(AFlashlight, BatteryAnchor);
+}
+
+// The same on the server and clients, always measured from the anchor so no error builds up over frames.
+float AFlashlight::GetBatteryTime() const
+{
+    const float Elapsed = FMath::Max(GetServerTime() - BatteryAnchor.ServerTime, 0.0f);
+    return FMath::Max(LightsOutCore::DrainBattery(BatteryAnchor.Life, Elapsed, BatteryDrainRate), 0.0f);
+}
+
+void AFlashlight::AddBatteryTime(float Time)
+{
+    if(Role < ROLE_Authority) { return; }
+    
+    SetBatteryAnchor(LightsOutCore::AddBattery(GetBatteryTime(), Time, MaxBatteryLife));
+}
+
+void AFlashlight::RestoreCheckpoint(float Life, float Percentage)
+{
+    if(Role < ROLE_Authority) { return; }
+    
+    if(IsOn)
+    {
+        ToggleLight();
+    }
+    CurrentPercentage = FMath::Clamp(Percentage, 0.0f, 100.0f);
+    Focus = uint8(FMath::RoundToInt(CurrentPercentage * 2.55f));
+    EvaluateLightCurve(CurrentPercentage);
+    SetBatteryAnchor(FMath::Clamp(Life, 0.0f, MaxBatteryLife));
+    PushLightState(true);
+}
+
+// Starts a new segment from the battery as it is now. Only needed when the drain rate changes.
+void AFlashlight::UpdateBatteryAnchor()
+{
+    SetBatteryAnchor(GetBatteryTime());
+}
+
+void AFlashlight::SetBatteryAnchor(float Life)
+{
+    BatteryAnchor.ServerTime = GetServerTime();
+    BatteryAnchor.Life = Life;
+    BatteryDrainRate = EvaluateDrainRate();
     
+    // The only place the battery can run out is the end of a segment that drains it.
+    if(BatteryDrainRate > 0)
+    {
+        GetWorldTimerManager().SetTimer(DepletionTimer, this, &AFlashlight::OnBatteryDepleted, FMath::Max(Life / BatteryDrainRate, KINDA_SMALL_NUMBER), false);
+    }
+    else
+    {
+        GetWorldTimerManager().ClearTimer(DepletionTimer);
+    }
+    OnBatteryChanged.Broadcast(BatteryAnchor.ServerTime, Life, BatteryDrainRate);
+}
+
+// Taken from the replicated focus rather than the smooth one, so clients drain at exactly the server's rate.
+float AFlashlight::EvaluateDrainRate() const
+{
+    if(!IsOn || !LightCurve.IsBuilt()) { return 0; }
+    return LightCurve.Evaluate(Focus / 2.55f).ConsumptionRate;
+}
+
+// Turns the light off and sends the player back to the last checkpoint. The game only stops if no
+// room has been solved yet.
+void AFlashlight::OnBatteryDepleted()
+{
+    if(!IsOn) { return; }
+    
+    // Server time is a float, so the timer can fire a hair before the segment runs out. The rest of
+    // it is then scheduled again.
+    if(!LightsOutCore::IsBatteryDead(LightsOutCore::DrainBattery(BatteryAnchor.Life, GetServerTime() - BatteryAnchor.ServerTime, BatteryDrainRate)))
+    {
+        UpdateBatteryAnchor();
+        return;
+    }
+    
+    BatteryAnchor.ServerTime = GetServerTime();
+    BatteryAnchor.Life = 0;
     ToggleLight();
+    if(!ULightsOutGameInstance::RestoreCheckpoint(this))
+    {
+        UGameplayStatics::SetGamePaused(GetWorld(),true);
+    }
+}
+
+void AFlashlight::OnRep_BatteryAnchor()
+{
+    BatteryDrainRate = EvaluateDrainRate();
+    OnBatteryChanged.Broadcast(BatteryAnchor.ServerTime, BatteryAnchor.Life, BatteryDrainRate);
+}
+
+float AFlashlight::GetServerTime() const
+{
+    const AGameState *GameState = GetWorld()->GameState;
+    return GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
 }
 
-void AFlashlight::CastLight()
+void AFlashlight::SetMyOwner(ALightsOutCharacter *NewOwner)
+{
+    MyOwner = NewOwner;
+    UpdateBeamQueryParams();
+}
+
+// The beam traces simple collision on its own channel, which only light proxies and blocking level
+// geometry respond to, so nothing is tested per triangle and no physical material is looked up.
+void AFlashlight::UpdateBeamQueryParams()
 {
     static FName FlashlightCast = FName(TEXT("FlashlightCast"));
     
-    // GetWorld()->DebugDrawTraceTag = FlashlightCast;
+    BeamQueryParams = FCollisionQueryParams(FlashlightCast, false, this);
+    BeamQueryParams.AddIgnoredActor(MyOwner);
+    BeamQueryParams.bTraceAsyncScene = true;
+    BeamQueryParams.bReturnPhysicalMaterial = false;
+}
+
+void AFlashlight::CastLight(float DeltaTime)
+{
+    LIGHTSOUT_SCOPE(CastLight);
     
-    // Vector math to point the raycast in the right direction.
+    // Vector math to point the beam in the right direction.
     FVector StartPosition = GetActorLocation();
     FVector ForwardVector = GetActorForwardVector();
     ForwardVector = ForwardVector.RotateAngleAxis(90, GetActorUpVector());
     ForwardVector.Normalize();
-    FVector EndPosition = StartPosition + FlashlightRange * ForwardVector;
     
-    // Sets raycast variables to ignore the flashlight and owner Actors.
-    FCollisionQueryParams TraceParameters(FlashlightCast, true);
-    TraceParameters.AddIgnoredActor(this);
-    TraceParameters.AddIgnoredActor(MyOwner);
-    TraceParameters.bTraceAsyncScene = true;
-    TraceParameters.bReturnPhysicalMaterial = true;
-    // TraceParameters.TraceTag = FlashlightCast;
+    // In async mode the rays traced last frame have finished by now, so they are counted first.
+    const bool UseAsyncTrace = CVarFlashlightAsyncTrace.GetValueOnGameThread() != 0;
+    if(UseAsyncTrace)
+    {
+        AccumulateCoverage(DeltaTime);
+    }
+    RayTargets.Reset();
+    RayResults.Reset();
+    BeamFrame++;
+    
+    // Asks the registry for every hittable object inside the outer cone, it only visits the nearby
+    // cells and tests their bounds against the cone in packed batches.
+    Candidates.Reset();
+    FHittableRegistry *Registry = FHittableRegistry::Find(GetWorld());
+    if(Registry)
+    {
+        FConeQuery Cone(StartPosition, ForwardVector, FlashlightRange, FlashlightRadius * InnerOuterConeRatio);
+        Registry->QueryCone(Cone, Candidates);
+    }
+    
+    // Only the objects inside the cone get occlusion rays, aimed at points spread across the disc
+    // they show the flashlight. A ray that hits nothing, or the object itself, sees the object lit.
+    // The frame's rays are shared between the objects, the spare ones going to each in turn.
+    const int32 RayBudget = FMath::Max(CVarFlashlightRaysPerFrame.GetValueOnGameThread(), 1);
+    const int32 NumSamples = FMath::Max(CVarFlashlightSamplesPerObject.GetValueOnGameThread(), 1);
+    for(int32 Index = 0; Index < Candidates.Num(); Index++)
+    {
+        AHittableObject *HittableObject = Candidates[Index];
+        FBeamCoverage &Coverage = BeamCoverage.FindOrAdd(HittableObject);
+        Coverage.LastQueried = BeamFrame;
+        
+        const int32 Turn = (Index + Candidates.Num() - int32(BeamFrame % Candidates.Num())) % Candidates.Num();
+        const int32 NumRays = FMath::Min(RayBudget / Candidates.Num() + (Turn < RayBudget % Candidates.Num() ? 1 : 0), NumSamples);
+        
+        const FVector Center = HittableObject->GetActorLocation();
+        FVector AxisX, AxisY;
+        (Center - StartPosition).GetSafeNormal().FindBestAxisVectors(AxisX, AxisY);
+        const float Radius = HittableObject->GetBeamRadius() * 0.9f;
+        
+        for(int32 Ray = 0; Ray < NumRays; Ray++, Coverage.NextSample++)
+        {
+            // Each sample has its own ring of equal area, and every pass over the samples turns the
+            // pattern so later passes land between the earlier points.
+            const int32 Sample = Coverage.NextSample % NumSamples;
+            const float Angle = (Sample + Coverage.NextSample / NumSamples) * BeamGoldenAngle;
+            const float Distance = Radius * FMath::Sqrt((Sample + 0.5f) / NumSamples);
+            const FVector Target = Center + (AxisX * FMath::Cos(Angle) + AxisY * FMath::Sin(Angle)) * Distance;
+            
+            const uint32 RayIndex = RayTargets.Add(HittableObject);
+            if(UseAsyncTrace)
+            {
+                // The physics work overlaps with the rest of the frame, the result comes back through
+                // OnAsyncTraceDone() with the ray's index as user data.
+                RayResults.Add(BeamRayPending);
+                GetWorld()->AsyncLineTraceByChannel(StartPosition, Target,
+                                                    COLLISION_FLASHLIGHT, BeamQueryParams, FCollisionResponseParams::DefaultResponseParam,
+                                                    &AsyncTraceDelegate, RayIndex);
+                continue;
+            }
+            
+            FHitResult Hit(ForceInit);
+            GetWorld()->LineTraceSingleByChannel(Hit, StartPosition, Target, COLLISION_FLASHLIGHT, BeamQueryParams);
+            RayResults.Add(!Hit.bBlockingHit || Hit.GetActor() == HittableObject ? 1 : 0);
+        }
+    }
+    
+    if(!UseAsyncTrace)
+    {
+        AccumulateCoverage(DeltaTime);
+    }
+    SelectBeamHits(DeltaTime, StartPosition, ForwardVector);
+}
+
+// Moves the coverage of every object the rays were aimed at towards the share of its rays that got
+// through. The rays of one object are next to each other.
+void AFlashlight::AccumulateCoverage(float DeltaTime)
+{
+    const float Blend = 1.0f - FMath::Exp(-DeltaTime / FMath::Max(CoverageTime, KINDA_SMALL_NUMBER));
+    
+    int32 First = 0;
+    while(First < RayTargets.Num())
+    {
+        int32 Last = First;
+        int32 NumRays = 0;
+        int32 NumLit = 0;
+        for(; Last < RayTargets.Num() && RayTargets[Last] == RayTargets[First]; Last++)
+        {
+            if(RayResults[Last] != BeamRayPending)
+            {
+                NumRays++;
+                NumLit += RayResults[Last];
+            }
+        }
+        
+        FBeamCoverage *Coverage = RayTargets[First].IsValid() ? BeamCoverage.Find(RayTargets[First]) : nullptr;
+        if(Coverage && NumRays > 0)
+        {
+            Coverage->Coverage = FMath::Lerp(Coverage->Coverage, float(NumLit) / NumRays, Blend);
+        }
+        First = Last;
+    }
+}
+
+// Objects that left the cone fade out, and of the ones covered enough the one nearest the beam's axis
+// is lit this frame. Lit objects stay lit down to a lower coverage, so an object at the edge of the
+// beam does not flicker.
+void AFlashlight::SelectBeamHits(float DeltaTime, const FVector &StartPosition, const FVector &Direction)
+{
+    const float Decay = FMath::Exp(-DeltaTime / FMath::Max(CoverageTime, KINDA_SMALL_NUMBER));
+    
+    BeamHits.Reset();
+    BeamChoices.Reset();
+    for(auto It = BeamCoverage.CreateIterator(); It; ++It)
+    {
+        AHittableObject *HittableObject = It.Key().Get();
+        FBeamCoverage &Coverage = It.Value();
+        if(Coverage.LastQueried != BeamFrame)
+        {
+            Coverage.Coverage *= Decay;
+            if(HittableObject == nullptr || Coverage.Coverage < KINDA_SMALL_NUMBER)
+            {
+                It.RemoveCurrent();
+                continue;
+            }
+        }
+        
+        if(HittableObject)
+        {
+            LightsOutCore::BeamCandidate Choice;
+            Choice.Alignment = (HittableObject->GetActorLocation() - StartPosition).GetSafeNormal() | Direction;
+            Choice.Coverage = Coverage.Coverage;
+            Choice.Threshold = BeamContacts.Contains(HittableObject) ? UnlitCoverage : LitCoverage;
+            BeamChoices.Add(Choice);
+            BeamHits.Add(HittableObject);
+        }
+    }
+    
+    // Gems in a sequence room sit close together, lighting every one in the cone would check them
+    // against the sequence in no particular order.
+    const int32 Target = LightsOutCore::PickBeamTarget(BeamChoices.GetData(), BeamChoices.Num());
+    AHittableObject *Aimed = Target != INDEX_NONE ? BeamHits[Target] : nullptr;
+    BeamHits.Reset();
+    if(Aimed)
+    {
+        BeamHits.Add(Aimed);
+    }
+}
+
+float AFlashlight::GetBeamCoverage(AHittableObject *HittableObject) const
+{
+    const FBeamCoverage *Coverage = BeamCoverage.Find(HittableObject);
+    return Coverage ? Coverage->Coverage : 0.0f;
+}
+
+// Compares the objects lit this frame against the ones lit before, so each object gets exactly one
+// OnBeamEnter() and OnBeamExit() per visit of the beam and OnBeamStay() in between.
+void AFlashlight::UpdateBeamContacts(float DeltaTime)
+{
+    const float Now = GetWorld()->GetTimeSeconds();
+    
+    // Refreshes the objects that were already lit, the rest are entering the beam.
+    BeamEntered.Reset();
+    for(AHittableObject *HittableObject : BeamHits)
+    {
+        float *LastSeen = BeamContacts.Find(HittableObject);
+        if(LastSeen)
+        {
+            *LastSeen = Now;
+        }
+        else
+        {
+            BeamEntered.AddUnique(HittableObject);
+        }
+    }
+    
+    // Objects the beam has not found for longer than the exit delay leave it, the others stay lit.
+    for(auto It = BeamContacts.CreateIterator(); It; ++It)
+    {
+        AHittableObject *HittableObject = It.Key().Get();
+        if(HittableObject == nullptr)
+        {
+            It.RemoveCurrent();
+        }
+        else if(Now - It.Value() > BeamExitDelay)
+        {
+            It.RemoveCurrent();
+            HittableObject->OnBeamExit(this);
+        }
+        else
+        {
+            // Dwell builds up with how much of the object is lit.
+            HittableObject->OnBeamStay(this, DeltaTime * GetBeamCoverage(HittableObject));
+        }
+    }
     
-    FHitResult Hit(ForceInit);
-    GetWorld()->LineTraceSingleByObjectType(Hit, StartPosition, EndPosition,
-                                            FCollisionObjectQueryParams::AllObjects, TraceParameters);
+    for(AHittableObject *HittableObject : BeamEntered)
+    {
+        BeamContacts.Add(HittableObject, Now);
+        HittableObject->OnBeamEnter(this);
+    }
+    
+    LIGHTSOUT_TRACK_MEMORY(STAT_LightsOut_BeamMemory, ReportedBeamMemory,
+        Candidates.GetAllocatedSize() + RayTargets.GetAllocatedSize() + RayResults.GetAllocatedSize() +
+        BeamCoverage.GetAllocatedSize() + BeamHits.GetAllocatedSize() + BeamEntered.GetAllocatedSize() + BeamChoices.GetAllocatedSize() +
+        BeamContacts.GetAllocatedSize());
+}
+
+void AFlashlight::ClearBeamContacts()
+{
+    TArray<TWeakObjectPtr<AHittableObject>> Contacts;
+    BeamContacts.GenerateKeyArray(Contacts);
+    BeamContacts.Empty();
+    BeamCoverage.Empty();
+    RayTargets.Reset();
+    RayResults.Reset();
     
-    // If the thing hit is a HittableObject, then the RespondToFlashlightHit() method is called on
-    // that object.
-    AHittableObject *HittableObject = Cast<AHittableObject>(Hit.GetActor());
-    if(HittableObject != nullptr)
+    for(TWeakObjectPtr<AHittableObject> &Contact : Contacts)
     {
-        HittableObject->RespondToFlashlightHit();
+        if(Contact.IsValid())
+        {
+            Contact->OnBeamExit(this);
+        }
     }
 }
 
-// Turns the flashlight on/off.
+void AFlashlight::OnAsyncTraceDone(const FTraceHandle &Handle, FTraceDatum &Data)
+{
+    // Results that arrive after the light was switched off are stale.
+    if(!IsOn || !RayTargets.IsValidIndex(Data.UserData)) { return; }
+    
+    const FHitResult *Hit = FHitResult::GetFirstBlockingHit(Data.OutHits);
+    RayResults[Data.UserData] = Hit == nullptr || Hit->GetActor() == RayTargets[Data.UserData].Get() ? 1 : 0;
+}
+
+// Turns the flashlight on/off. The flashlight only has work to do while it is on, so it only ticks then.
 void AFlashlight::ToggleLight()
 {
+    if(Role < ROLE_Authority) { return; }
+    
     IsOn = !IsOn;
-    SpotLightComponent->SetIntensity(IsOn ? FlashlightIntensity : 0);
-    FlashlightAudioComponent = PlaySound(IsOn ? ToggleOnSound : ToggleOffSound);
+    SetActorTickEnabled(IsOn);
+    if(!IsOn)
+    {
+        ClearBeamContacts();
+    }
+    UpdateBatteryAnchor();
+    PushLightState(true);
+    FlashlightAudioComponent = PlaySound(IsOn ? ToggleOnSoundAsset : ToggleOffSoundAsset);
 }
 
-// Updates all of the variables based on a percentage.
-void AFlashlight::LerpLight(float DeltaTime)
+void AFlashlight::OnRep_IsOn()
 {
-    if(DeltaTime == 0) { return; }
-    
-    CurrentPercentage += LerpSpeed * DeltaTime;
-    CurrentPercentage = FMath::Clamp(CurrentPercentage, 0.0f, 100.0f);
+    PushLightState(true);
+    FlashlightAudioComponent = PlaySound(IsOn ? ToggleOnSoundAsset : ToggleOffSoundAsset);
+}
+
+void AFlashlight::OnRep_Focus()
+{
+    if(!LightCurve.IsBuilt()) { return; }
     
-    LerpConsumptionRate(CurrentPercentage);
-    LerpRadius(CurrentPercentage);
-    LerpIntensity(CurrentPercentage);
-    LerpRange(CurrentPercentage);
+    // Replication already limits how often this changes, so every update goes to the renderer.
+    CurrentPercentage = Focus / 2.55f;
+    EvaluateLightCurve(CurrentPercentage);
+    PushLightState(true);
 }
 
-void AFlashlight::LerpConsumptionRate(float Percentage)
+// Updates all of the variables based on a percentage.
+void AFlashlight::LerpLight(float DeltaTime)
 {
-    ConsumptionRate = FMath::Lerp(MinimumConsumptionRate, MaximumConsumptionRate, Percentage / 100.0f);
+    LIGHTSOUT_SCOPE(LerpLight);
+    
+    if(DeltaTime == 0)
+    {
+        // Pushes whatever small change was held back once the focus stops moving.
+        if(HasPendingLightState)
+        {
+            PushLightState(true);
+        }
+        return;
+    }
+    
+    CurrentPercentage = LightsOutCore::StepFocus(CurrentPercentage, LerpSpeed, DeltaTime);
+    EvaluateLightCurve(CurrentPercentage);
+    PushLightState(false);
+    
+    // The drain rate follows the focus, so the battery is re-sent whenever the replicated byte changes.
+    const uint8 NewFocus = uint8(FMath::RoundToInt(CurrentPercentage * 2.55f));
+    if(NewFocus != Focus)
+    {
+        Focus = NewFocus;
+        UpdateBatteryAnchor();
+    }
 }
 
-void AFlashlight::LerpRadius(float Percentage)
+// Samples all four channels once so changing the focus is a table lookup instead of four lerps.
+void AFlashlight::BuildLightCurve()
 {
-    FlashlightRadius = FMath::Lerp(MinimumRadius, MaximumRadius, 1.0f - Percentage / 100.0f);
-    SpotLightComponent->SetInnerConeAngle(FlashlightRadius);
-    SpotLightComponent->SetOuterConeAngle(FlashlightRadius * InnerOuterConeRatio);
+    LightsOutCore::FlashlightLimits Limits;
+    Limits.MinimumConsumptionRate = MinimumConsumptionRate;
+    Limits.MaximumConsumptionRate = MaximumConsumptionRate;
+    Limits.MinimumRadius = MinimumRadius;
+    Limits.MaximumRadius = MaximumRadius;
+    Limits.MinimumIntensity = MinimumIntensity;
+    Limits.MaximumIntensity = MaximumIntensity;
+    Limits.MinimumRange = MinimumRange;
+    Limits.MaximumRange = MaximumRange;
+    
+    LightCurveSamples = FMath::Max(LightCurveSamples, 2);
+    LightCurve.Build(Limits, LightCurveSamples);
+    LIGHTSOUT_TRACK_MEMORY(STAT_LightsOut_LightCurveMemory, ReportedCurveMemory, LightCurve.GetAllocatedSize());
 }
 
-void AFlashlight::LerpIntensity(float Percentage)
+void AFlashlight::EvaluateLightCurve(float Percentage)
 {
-    FlashlightIntensity = FMath::Lerp(MinimumIntensity, MaximumIntensity, Percentage / 100.0f);
-    SpotLightComponent->SetIntensity(FlashlightIntensity);
+    const LightsOutCore::FlashlightSample Sample = LightCurve.Evaluate(Percentage);
+    FlashlightRadius = Sample.Radius;
+    FlashlightIntensity = Sample.Intensity;
+    FlashlightRange = Sample.Range;
 }
 
-void AFlashlight::LerpRange(float Percentage)
+// Sends the spotlight's parameters to the render thread in one update, and only when the change
+// would be visible. Each of the component's setters would otherwise send its own update.
+void AFlashlight::PushLightState(bool Force)
 {
-    FlashlightRange = FMath::Lerp(MinimumRange, MaximumRange, Percentage / 100.0f);
-    SpotLightComponent->SetAttenuationRadius(FlashlightRange);
+    const float Intensity = IsOn ? FlashlightIntensity : 0;
+    
+    const bool HasChanged =
+        FMath::Abs(FlashlightRadius - SpotLightComponent->InnerConeAngle) > ConeAngleThreshold ||
+        FMath::Abs(Intensity - SpotLightComponent->Intensity) > LightChangeThreshold * SpotLightComponent->Intensity ||
+        FMath::Abs(FlashlightRange - SpotLightComponent->AttenuationRadius) > LightChangeThreshold * SpotLightComponent->AttenuationRadius;
+    
+    if(!Force && !HasChanged)
+    {
+        HasPendingLightState = true;
+        return;
+    }
+    
+    SpotLightComponent->InnerConeAngle = FlashlightRadius;
+    SpotLightComponent->OuterConeAngle = FlashlightRadius * InnerOuterConeRatio;
+    SpotLightComponent->Intensity = Intensity;
+    SpotLightComponent->AttenuationRadius = FlashlightRange;
+    SpotLightComponent->MarkRenderStateDirty();
+    HasPendingLightState = false;
 }
 
-UAudioComponent *AFlashlight::PlaySound(USoundCue *Sound)
+UAudioComponent *AFlashlight::PlaySound(const TAssetPtr<USoundCue> &SoundAsset)
 {
+    USoundCue *Sound = ULightsOutGameInstance::Resolve(this, SoundAsset);
     UAudioComponent *AC = nullptr;
     if(Sound)
     {
-        AC = UGameplayStatics::SpawnSoundAttached(Sound, RootComponent);
+        AC = FAudioVoicePool::PlaySoundAttached(Sound, RootComponent);
     }
     return AC;
 }
\ No newline at end of file
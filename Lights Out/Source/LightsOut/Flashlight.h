@@ -3,8 +3,39 @@
 #pragma once
 
 #include "GameFramework/Actor.h"
+#include "ConeQuery.h"
+#include "LightsOutCore/Battery.h"
+#include "LightsOutCore/FlashlightModel.h"
 #include "Flashlight.generated.h"
 
+// Start of the straight line the battery drains along until the drain rate next changes. The rate
+// follows from the replicated focus and switch, so the server and clients work out the same life from
+// these two numbers and nothing has to be sent in between.
+USTRUCT()
+struct FBatteryAnchor
+{
+    GENERATED_USTRUCT_BODY()
+
+    UPROPERTY()
+    float ServerTime = 0;
+    UPROPERTY()
+    float Life = 0;
+};
+
+// How much of an object the beam lights, from 0 to 1, smoothed over the frames its rays were traced in.
+struct FBeamCoverage
+{
+    float Coverage = 0;
+    // Next point across the object a ray is aimed at, counting up forever so the pattern keeps turning.
+    int32 NextSample = 0;
+    // Beam frame the object was last inside the cone.
+    uint32 LastQueried = 0;
+};
+
+// Sent with the battery anchor and the rate it is draining at whenever the rate changes, so listeners
+// can extrapolate the battery on the server's clock themselves instead of asking for it every frame.
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnBatteryChanged, float /*AnchorTime*/, float /*Life*/, float /*DrainRate*/);
+
 UCLASS()
 class LIGHTSOUT_API AFlashlight : public AActor
 {
@@ -13,40 +44,68 @@ class LIGHTSOUT_API AFlashlight : public AActor
     public:
     
         AFlashlight();
+        virtual void PostLoad() override;
         virtual void BeginPlay() override;
+        virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
         virtual void Tick(float DeltaSeconds) override;
+        virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &OutLifetimeProps) const override;
 
         USkeletalMeshComponent *GetFlashlightMesh() { return FlashlightMesh; }
         void SetFlashlightMesh(USkeletalMeshComponent *NewMesh) { FlashlightMesh = NewMesh; }
     
         UFUNCTION(BlueprintCallable, BlueprintPure, Category="ParentClass")
         class ALightsOutCharacter *GetMyOwner() { return MyOwner; }
-        void SetMyOwner(class ALightsOutCharacter *NewOwner) { MyOwner = NewOwner; }
-    
-        float GetBatteryTime() { return BatteryLife; }
-        void AddBatteryTime(float Time)
-        {
-            BatteryLife += Time;
-            if(BatteryLife > MaxBatteryLife)
-            {
-                BatteryLife = MaxBatteryLife;
-            }
-        }
+        void SetMyOwner(class ALightsOutCharacter *NewOwner);
+    
+        // Battery life left in seconds, extrapolated from the last anchor on the server and clients alike.
+        UFUNCTION(BlueprintCallable, BlueprintPure, Category = Battery)
+        float GetBatteryTime() const;
+        float GetMaxBatteryTime() const { return MaxBatteryLife; }
+        float GetBatteryDrainRate() const { return BatteryDrainRate; }
+        void AddBatteryTime(float Time);
+        float GetFocusPercentage() const { return CurrentPercentage; }
+        // World time on the server, the clock the battery drains on.
+        float GetServerTime() const;
+    
+        // Puts the battery and focus back to a checkpoint, leaving the light switched off.
+        void RestoreCheckpoint(float Life, float Percentage);
+    
+        FOnBatteryChanged OnBatteryChanged;
     
         void ToggleLight();
+        bool IsLightOn() const { return IsOn; }
     
         void SetLerp(float Value) { LerpDirection = Value; }
     
+        // Share of the object the beam currently lights, 0 if it is not in the beam.
+        float GetBeamCoverage(class AHittableObject *HittableObject) const;
+    
     protected:
     
         void Initialize();
+        void UpdateBatteryAnchor();
+        void SetBatteryAnchor(float Life);
+        float EvaluateDrainRate() const;
+        void OnBatteryDepleted();
         void LerpLight(float Percentage);
-        void LerpConsumptionRate(float Percentage);
-        void LerpRadius(float Percentage);
-        void LerpIntensity(float Percentage);
-        void LerpRange(float Percentage);
-        void CastLight();
-        class UAudioComponent *PlaySound(class USoundCue *Sound);
+        void BuildLightCurve();
+        void EvaluateLightCurve(float Percentage);
+        void PushLightState(bool Force);
+        void UpdateBeamQueryParams();
+        void CastLight(float DeltaTime);
+        void AccumulateCoverage(float DeltaTime);
+        void SelectBeamHits(float DeltaTime, const FVector &StartPosition, const FVector &Direction);
+        void UpdateBeamContacts(float DeltaTime);
+        void ClearBeamContacts();
+        void OnAsyncTraceDone(const FTraceHandle &Handle, FTraceDatum &Data);
+    
+        UFUNCTION()
+        void OnRep_IsOn();
+        UFUNCTION()
+        void OnRep_Focus();
+        UFUNCTION()
+        void OnRep_BatteryAnchor();
+        class UAudioComponent *PlaySound(const TAssetPtr<class USoundCue> &SoundAsset);
     
     protected:
     
@@ -61,21 +120,35 @@ class LIGHTSOUT_API AFlashlight : public AActor
         float LerpSpeed = 7.5f;
         UPROPERTY(EditDefaultsOnly, Category = Rate)
         float InitialPercentage = 0;
+        //Number of points the focus range is sampled at
+        UPROPERTY(EditDefaultsOnly, Category = Rate, meta = (ClampMin = "2"))
+        int32 LightCurveSamples = 101;
+        //Smallest relative change in intensity or range that is sent to the renderer
+        UPROPERTY(EditDefaultsOnly, Category = Rate)
+        float LightChangeThreshold = 0.01f;
+        //Smallest change in cone angle, in degrees, that is sent to the renderer
+        UPROPERTY(EditDefaultsOnly, Category = Rate)
+        float ConeAngleThreshold = 0.1f;
     
         UPROPERTY(EditDefaultsOnly, Category = Color)
         FColor LightColor;
     
         UPROPERTY(EditDefaultsOnly, Category = Sound)
-        class USoundCue *ToggleOnSound;
+        TAssetPtr<class USoundCue> ToggleOnSoundAsset;
         UPROPERTY(EditDefaultsOnly, Category = Sound)
-        class USoundCue *ToggleOffSound;
+        TAssetPtr<class USoundCue> ToggleOffSoundAsset;
+        // Hard references from before the sounds were loaded softly, moved over in PostLoad().
+        UPROPERTY()
+        class USoundCue *ToggleOnSound_DEPRECATED;
+        UPROPERTY()
+        class USoundCue *ToggleOffSound_DEPRECATED;
     
         //Get the maximum battery life which can be changed by blueprint
         UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Battery)
         float MaxBatteryLife = 300.0f;
-        //Get the current battery life but cannot by be changed by blueprint
-        UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Battery)
-        float BatteryLife = 300.0f;
+        //Battery life the flashlight starts with, the life after that comes from GetBatteryTime()
+        UPROPERTY(EditAnywhere, Category = Battery)
+        float InitialBatteryLife = 300.0f;
         UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Battery)
         float MinimumConsumptionRate = 1.0f;
         UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Battery)
@@ -98,15 +171,65 @@ class LIGHTSOUT_API AFlashlight : public AActor
         UPROPERTY(EditDefaultsOnly, Category = Range)
         float MaximumRange = 1000.0f;
     
+        //How long an object stays lit after the beam stops finding it, so flicker at the edge of the beam does not exit and re-enter
+        UPROPERTY(EditDefaultsOnly, Category = Beam)
+        float BeamExitDelay = 0.1f;
+        //Seconds over which an object's lit coverage follows what the beam's rays see
+        UPROPERTY(EditDefaultsOnly, Category = Beam)
+        float CoverageTime = 0.15f;
+        //Share of an object that has to be lit for the beam to start lighting it
+        UPROPERTY(EditDefaultsOnly, Category = Beam, meta = (ClampMin = "0", ClampMax = "1"))
+        float LitCoverage = 0.5f;
+        //Share below which a lit object stops being lit
+        UPROPERTY(EditDefaultsOnly, Category = Beam, meta = (ClampMin = "0", ClampMax = "1"))
+        float UnlitCoverage = 0.25f;
+    
     private:
     
         float CurrentPercentage;
-        float ConsumptionRate;
         float FlashlightRadius;
         float FlashlightIntensity;
         float FlashlightRange;
+        LightsOutCore::FlashlightCurve LightCurve;
+        bool HasPendingLightState;
     
         class ALightsOutCharacter *MyOwner;
+        UPROPERTY(ReplicatedUsing = OnRep_IsOn)
         bool IsOn;
         float LerpDirection;
+    
+        // The focus percentage quantized to a byte, which is all clients need to rebuild the light.
+        UPROPERTY(ReplicatedUsing = OnRep_Focus)
+        uint8 Focus;
+        UPROPERTY(ReplicatedUsing = OnRep_BatteryAnchor)
+        FBatteryAnchor BatteryAnchor;
+        float BatteryDrainRate = 0;
+        // Fires on the server when the current segment drains the battery.
+        FTimerHandle DepletionTimer;
+    
+        // Occlusion trace settings, rebuilt only when the owner changes.
+        FCollisionQueryParams BeamQueryParams;
+    
+        // Scratch space for the cone query, kept between frames to avoid reallocating.
+        TArray<class AHittableObject*> Candidates;
+    
+        // The object each of this frame's rays was aimed at and whether it got through, indexed by the
+        // async traces' user data. Async results are counted on the following frame.
+        FTraceDelegate AsyncTraceDelegate;
+        TArray<TWeakObjectPtr<class AHittableObject>> RayTargets;
+        TArray<uint8> RayResults;
+    
+        // Coverage of every object in or recently in the beam.
+        TMap<TWeakObjectPtr<class AHittableObject>, FBeamCoverage> BeamCoverage;
+        uint32 BeamFrame = 0;
+    
+        // Objects found lit this frame, and every object currently lit with the last time the beam found it.
+        TArray<class AHittableObject*> BeamHits;
+        TArray<class AHittableObject*> BeamEntered;
+        TArray<LightsOutCore::BeamCandidate> BeamChoices;
+        TMap<TWeakObjectPtr<class AHittableObject>, float> BeamContacts;
+    
+        // Sizes last reported to the LightsOut memory stats.
+        int64 ReportedBeamMemory = 0;
+        int64 ReportedCurveMemory = 0;
 };
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "GemLightAnimator.h"
+
+FGemLightAnimator *FGemLightAnimator::Get(UWorld *World)
+{
+    return TLightsOutPerWorld<FGemLightAnimator>::Get(World);
+}
+
+void FGemLightAnimator::Animate(UPointLightComponent *Light, float TargetIntensity, float Speed)
+{
+    if(Light == nullptr) { return; }
+
+    int32 Index = Lights.IndexOfByKey(Light);
+    if(Index == INDEX_NONE)
+    {
+        if(Light->Intensity == TargetIntensity) { return; }
+
+        Index = Lights.Add(Light);
+        Intensities.Add(Light->Intensity);
+        Targets.AddUninitialized();
+        Speeds.AddUninitialized();
+    }
+    Targets[Index] = TargetIntensity;
+    Speeds[Index] = FMath::Max(Speed, 0.0f);
+
+    // A light that cannot move snaps straight to its target.
+    if(Speeds[Index] == 0)
+    {
+        Light->SetIntensity(TargetIntensity);
+        RemoveAt(Index);
+    }
+}
+
+void FGemLightAnimator::Tick(float DeltaTime)
+{
+    for(int32 Index = Lights.Num() - 1; Index >= 0; Index--)
+    {
+        UPointLightComponent *Light = Lights[Index].Get();
+        if(Light == nullptr)
+        {
+            RemoveAt(Index);
+            continue;
+        }
+
+        const float Step = Speeds[Index] * DeltaTime;
+        const float Remaining = Targets[Index] - Intensities[Index];
+        const bool HasArrived = FMath::Abs(Remaining) <= Step;
+        Intensities[Index] = HasArrived ? Targets[Index] : Intensities[Index] + FMath::Sign(Remaining) * Step;
+        Light->SetIntensity(Intensities[Index]);
+
+        if(HasArrived)
+        {
+            RemoveAt(Index);
+        }
+    }
+}
+
+void FGemLightAnimator::RemoveAt(int32 Index)
+{
+    Lights.RemoveAtSwap(Index);
+    Intensities.RemoveAtSwap(Index);
+    Targets.RemoveAtSwap(Index);
+    Speeds.RemoveAtSwap(Index);
+}
+
+TStatId FGemLightAnimator::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(FGemLightAnimator, STATGROUP_Tickables);
+}
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Tickable.h"
+#include "LightsOutPerWorld.h"
+
+/**
+ * Fades point lights towards a target intensity. Every animating light in the world sits in one set
+ * of parallel arrays that is advanced in a single loop per frame, and a light leaves the set as soon
+ * as it reaches its target, so idle lights cost nothing.
+ */
+class LIGHTSOUT_API FGemLightAnimator : public FTickableGameObject
+{
+    public:
+
+        // Returns the animator for the world, creating it if needed.
+        static FGemLightAnimator *Get(UWorld *World);
+
+        // Fades the light from its current intensity to the target at Speed intensity units per
+        // second. A light that is already fading is redirected from wherever it is.
+        void Animate(UPointLightComponent *Light, float TargetIntensity, float Speed);
+
+        // FTickableGameObject interface
+        virtual void Tick(float DeltaTime) override;
+        virtual bool IsTickable() const override { return Lights.Num() > 0; }
+        virtual TStatId GetStatId() const override;
+
+    private:
+
+        friend class TLightsOutPerWorld<FGemLightAnimator>;
+
+        explicit FGemLightAnimator(UWorld *InWorld) {}
+
+        void RemoveAt(int32 Index);
+
+    private:
+
+        // Parallel arrays, one entry per animating light.
+        TArray<TWeakObjectPtr<UPointLightComponent>> Lights;
+        TArray<float> Intensities;
+        TArray<float> Targets;
+        TArray<float> Speeds;
+};
@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "GemLightBudget.h"
+
+static TAutoConsoleVariable<int32> CVarLightBudgetMaxDynamic(
+    TEXT("LightsOut.LightBudget.MaxDynamicLights"),
+    4,
+    TEXT("Most gem lights rendered as dynamic shadowed point lights at once, the rest use emissive impostors."));
+
+static TAutoConsoleVariable<float> CVarLightBudgetHysteresis(
+    TEXT("LightsOut.LightBudget.Hysteresis"),
+    1.25f,
+    TEXT("Significance multiplier for lights that are already dynamic, so lights of similar rank do not swap every frame."));
+
+static TAutoConsoleVariable<float> CVarLightBudgetEmissiveScale(
+    TEXT("LightsOut.LightBudget.EmissiveScale"),
+    0.002f,
+    TEXT("Emissive strength an impostor gets per unit of the light's intensity."));
+
+// Vector parameter the gem materials expose for their glow.
+static const FName ImpostorEmissiveParameter(TEXT("EmissiveColor"));
+
+FGemLightBudget *FGemLightBudget::Get(UWorld *World)
+{
+    return TLightsOutPerWorld<FGemLightBudget>::Get(World);
+}
+
+FGemLightBudget *FGemLightBudget::Find(const UWorld *World)
+{
+    return TLightsOutPerWorld<FGemLightBudget>::Find(World);
+}
+
+FGemLightBudget::FGemLightBudget(UWorld *InWorld)
+    : World(InWorld)
+{
+}
+
+void FGemLightBudget::Register(UPointLightComponent *Light, UMeshComponent *ImpostorMesh)
+{
+    if(Light == nullptr || Lights.Contains(Light)) { return; }
+
+    UMaterialInstanceDynamic *Impostor = nullptr;
+    if(ImpostorMesh && ImpostorMesh->GetNumMaterials() > 0)
+    {
+        Impostor = ImpostorMesh->CreateAndSetMaterialInstanceDynamic(0);
+    }
+
+    Lights.Add(Light);
+    Impostors.Add(Impostor);
+    IsDynamic.Add(true);
+    ImpostorIntensities.Add(-1.0f);
+
+    // Starts hidden, the next ranking decides whether it earns a dynamic light.
+    SetDynamic(Lights.Num() - 1, false);
+}
+
+void FGemLightBudget::Unregister(UPointLightComponent *Light)
+{
+    const int32 Index = Lights.IndexOfByKey(Light);
+    if(Index != INDEX_NONE)
+    {
+        Lights.RemoveAtSwap(Index);
+        Impostors.RemoveAtSwap(Index);
+        IsDynamic.RemoveAtSwap(Index);
+        ImpostorIntensities.RemoveAtSwap(Index);
+    }
+}
+
+void FGemLightBudget::Tick(float DeltaTime)
+{
+    ViewLocations.Reset();
+    ViewDirections.Reset();
+    for(FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        APlayerController *PlayerController = *It;
+        if(PlayerController && PlayerController->IsLocalController())
+        {
+            FVector Location;
+            FRotator Rotation;
+            PlayerController->GetPlayerViewPoint(Location, Rotation);
+            ViewLocations.Add(Location);
+            ViewDirections.Add(Rotation.Vector());
+        }
+    }
+
+    for(int32 Index = Lights.Num() - 1; Index >= 0; Index--)
+    {
+        if(!Lights[Index].IsValid())
+        {
+            Lights.RemoveAtSwap(Index);
+            Impostors.RemoveAtSwap(Index);
+            IsDynamic.RemoveAtSwap(Index);
+            ImpostorIntensities.RemoveAtSwap(Index);
+        }
+    }
+
+    const float Hysteresis = CVarLightBudgetHysteresis.GetValueOnGameThread();
+    Significance.SetNumUninitialized(Lights.Num());
+    Ranking.Reset();
+    for(int32 Index = 0; Index < Lights.Num(); Index++)
+    {
+        Significance[Index] = GetSignificance(Index) * (IsDynamic[Index] ? Hysteresis : 1.0f);
+        if(Significance[Index] > 0)
+        {
+            Ranking.Add(Index);
+        }
+    }
+
+    const int32 MaxDynamic = FMath::Max(0, CVarLightBudgetMaxDynamic.GetValueOnGameThread());
+    if(Ranking.Num() > MaxDynamic)
+    {
+        const TArray<float> &Scores = Significance;
+        Ranking.Sort([&Scores](int32 A, int32 B) { return Scores[A] > Scores[B]; });
+        Ranking.SetNum(MaxDynamic, false);
+    }
+
+    // Only lights whose state flips are touched, so a stable ranking costs no render updates.
+    TBitArray<> Chosen(false, Lights.Num());
+    for(int32 Index : Ranking)
+    {
+        Chosen[Index] = true;
+    }
+    for(int32 Index = 0; Index < Lights.Num(); Index++)
+    {
+        SetDynamic(Index, Chosen[Index]);
+    }
+}
+
+// How much the light contributes to what the players see: its brightness scaled by how large its
+// radius appears from the closest view, with lights behind the view counting for less.
+float FGemLightBudget::GetSignificance(int32 Index) const
+{
+    const UPointLightComponent *Light = Lights[Index].Get();
+    if(Light->Intensity <= 0 || ViewLocations.Num() == 0)
+    {
+        return 0.0f;
+    }
+
+    const FVector Location = Light->GetComponentLocation();
+    float Best = 0.0f;
+    for(int32 View = 0; View < ViewLocations.Num(); View++)
+    {
+        const FVector ToLight = Location - ViewLocations[View];
+        const float Distance = FMath::Max(ToLight.Size(), 1.0f);
+        const float Facing = FVector::DotProduct(ToLight / Distance, ViewDirections[View]) > 0 ? 1.0f : 0.25f;
+        Best = FMath::Max(Best, Facing * FMath::Square(Light->AttenuationRadius / Distance));
+    }
+    return Best * Light->Intensity;
+}
+
+void FGemLightBudget::SetDynamic(int32 Index, bool Dynamic)
+{
+    UPointLightComponent *Light = Lights[Index].Get();
+    if(IsDynamic[Index] != Dynamic)
+    {
+        IsDynamic[Index] = Dynamic;
+        Light->SetVisibility(Dynamic);
+        Light->SetCastShadows(Dynamic);
+    }
+
+    // The impostor glows in place of a hidden light and follows its intensity, which the gem may still change.
+    UMaterialInstanceDynamic *Impostor = Impostors[Index];
+    const float ImpostorIntensity = Dynamic ? 0.0f : Light->Intensity;
+    if(Impostor && ImpostorIntensity != ImpostorIntensities[Index])
+    {
+        ImpostorIntensities[Index] = ImpostorIntensity;
+        const float Scale = ImpostorIntensity * CVarLightBudgetEmissiveScale.GetValueOnGameThread();
+        Impostor->SetVectorParameterValue(ImpostorEmissiveParameter, FLinearColor(Light->LightColor) * Scale);
+    }
+}
+
+TStatId FGemLightBudget::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(FGemLightBudget, STATGROUP_Tickables);
+}
+
+void FGemLightBudget::AddReferencedObjects(FReferenceCollector &Collector)
+{
+    Collector.AddReferencedObjects(Impostors);
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Tickable.h"
+#include "LightsOutPerWorld.h"
+
+/**
+ * Keeps the number of dynamic gem lights fixed however many gems are lit. Every frame the lit gems are
+ * ranked by how large and bright they appear to the local players, the top few keep real shadowed
+ * point lights and the rest hide their light and glow through an emissive parameter on their mesh
+ * instead.
+ */
+class LIGHTSOUT_API FGemLightBudget : public FTickableGameObject, public FGCObject
+{
+    public:
+
+        // Returns the budget for the world, creating it if needed.
+        static FGemLightBudget *Get(UWorld *World);
+        // Returns the budget for the world or nullptr if nothing has used it yet.
+        static FGemLightBudget *Find(const UWorld *World);
+
+        // Adds a gem light. The mesh, if any, gets a dynamic material instance used as its impostor.
+        void Register(UPointLightComponent *Light, UMeshComponent *ImpostorMesh);
+        void Unregister(UPointLightComponent *Light);
+
+        // FTickableGameObject interface
+        virtual void Tick(float DeltaTime) override;
+        virtual bool IsTickable() const override { return Lights.Num() > 0; }
+        virtual TStatId GetStatId() const override;
+
+        // FGCObject interface
+        virtual void AddReferencedObjects(FReferenceCollector &Collector) override;
+
+    private:
+
+        friend class TLightsOutPerWorld<FGemLightBudget>;
+
+        explicit FGemLightBudget(UWorld *InWorld);
+
+        float GetSignificance(int32 Index) const;
+        void SetDynamic(int32 Index, bool Dynamic);
+
+    private:
+
+        UWorld *World;
+
+        // Parallel arrays, one entry per registered light.
+        TArray<TWeakObjectPtr<UPointLightComponent>> Lights;
+        TArray<UMaterialInstanceDynamic*> Impostors;
+        TArray<bool> IsDynamic;
+        TArray<float> ImpostorIntensities;
+
+        // Scratch space for the ranking, kept between frames to avoid reallocating.
+        TArray<FVector> ViewLocations;
+        TArray<FVector> ViewDirections;
+        TArray<int32> Ranking;
+        TArray<float> Significance;
+};
@@ -2,23 +2,56 @@
 
 #include "LightsOut.h"
 #include "HittableObject.h"
+#include "HittableRegistry.h"
 
 AHittableObject::AHittableObject()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
+    
+    // Subclasses that bring their own root attach the proxy to it.
+    LightProxy = CreateDefaultSubobject<USphereComponent>(TEXT("LightProxy"));
+    LightProxy->InitSphereRadius(BeamRadius);
+    LightProxy->SetCollisionProfileName(TEXT("FlashlightProxy"));
+    LightProxy->bGenerateOverlapEvents = false;
+    RootComponent = LightProxy;
+}
+
+void AHittableObject::OnConstruction(const FTransform &Transform)
+{
+    Super::OnConstruction(Transform);
+    
+    LightProxy->SetSphereRadius(BeamRadius);
 }
 
 void AHittableObject::BeginPlay()
 {
 	Super::BeginPlay();
+    
+    FHittableRegistry::Get(GetWorld())->Register(this);
 }
 
-void AHittableObject::Tick( float DeltaTime )
+void AHittableObject::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick( DeltaTime );
+    FHittableRegistry *Registry = FHittableRegistry::Find(GetWorld());
+    if(Registry)
+    {
+        Registry->Unregister(this);
+    }
+    
+    Super::EndPlay(EndPlayReason);
+}
+
+void AHittableObject::OnBeamEnter(AFlashlight *Flashlight)
+{
+    
+}
+
+void AHittableObject::OnBeamStay(AFlashlight *Flashlight, float DeltaDwell)
+{
+    
 }
 
-void AHittableObject::RespondToFlashlightHit()
+void AHittableObject::OnBeamExit(AFlashlight *Flashlight)
 {
     
 }
@@ -13,8 +13,28 @@ class LIGHTSOUT_API AHittableObject : public AActor
     public:
         AHittableObject();
         virtual void BeginPlay() override;
-        virtual void Tick( float DeltaSeconds ) override;
+        virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     public:
-        virtual void RespondToFlashlightHit();
+        // Called once when a flashlight beam starts lighting this object, every frame it stays lit
+        // with the time lit since the last call, and once when the beam leaves it.
+        virtual void OnBeamEnter(class AFlashlight *Flashlight);
+        virtual void OnBeamStay(class AFlashlight *Flashlight, float DeltaDwell);
+        virtual void OnBeamExit(class AFlashlight *Flashlight);
+        float GetBeamRadius() const { return BeamRadius; }
+        class USphereComponent *GetLightProxy() const { return LightProxy; }
+        virtual void OnConstruction(const FTransform &Transform) override;
+
+    protected:
+        //Simple shape the beam's occlusion trace hits, the object's own meshes are never traced against
+        UPROPERTY(VisibleDefaultsOnly, Category = Flashlight)
+        class USphereComponent *LightProxy;
+    
+        //Radius of the sphere the flashlight beam has to touch to hit this object
+        UPROPERTY(EditAnywhere, Category = Flashlight)
+        float BeamRadius = 25.0f;
+
+    private:
+        friend class FHittableRegistry;
+        int32 RegistryIndex = INDEX_NONE;
 };
@@ -0,0 +1,222 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "HittableRegistry.h"
+#include "HittableObject.h"
+#include "ConvexVolume.h"
+
+FHittableRegistry *FHittableRegistry::Get(UWorld *World)
+{
+    return TLightsOutPerWorld<FHittableRegistry>::Get(World);
+}
+
+FHittableRegistry *FHittableRegistry::Find(const UWorld *World)
+{
+    return TLightsOutPerWorld<FHittableRegistry>::Find(World);
+}
+
+FHittableRegistry::FHittableRegistry(const UWorld *InWorld)
+    : CellSize(500.0f)
+    , MaxRadius(0.0f)
+    , LastSyncFrame(0)
+{
+}
+
+void FHittableRegistry::Register(AHittableObject *Object)
+{
+    if(Object->RegistryIndex != INDEX_NONE) { return; }
+
+    USceneComponent *Root = Object->GetRootComponent();
+
+    FEntry Entry;
+    Entry.Object = Object;
+    Entry.Center = Object->GetActorLocation();
+    Entry.Radius = Object->GetBeamRadius();
+    Entry.Cell = GetCell(Entry.Center);
+    Entry.IsMovable = Root && Root->Mobility == EComponentMobility::Movable;
+
+    const int32 EntryIndex = Entries.Add(Entry);
+    Object->RegistryIndex = EntryIndex;
+    AddToCell(EntryIndex);
+    if(Entry.IsMovable)
+    {
+        MovableEntries.Add(EntryIndex);
+    }
+    MaxRadius = FMath::Max(MaxRadius, Entry.Radius);
+}
+
+void FHittableRegistry::Unregister(AHittableObject *Object)
+{
+    const int32 EntryIndex = Object->RegistryIndex;
+    if(EntryIndex == INDEX_NONE) { return; }
+
+    RemoveFromCell(EntryIndex);
+    if(Entries[EntryIndex].IsMovable)
+    {
+        MovableEntries.RemoveSingleSwap(EntryIndex);
+    }
+    Entries.RemoveAt(EntryIndex);
+    Object->RegistryIndex = INDEX_NONE;
+}
+
+void FHittableRegistry::Update(AHittableObject *Object)
+{
+    if(Object->RegistryIndex != INDEX_NONE)
+    {
+        UpdateEntry(Object->RegistryIndex);
+    }
+}
+
+void FHittableRegistry::QuerySphere(const FVector &Center, float Radius, TArray<AHittableObject*> &OutObjects)
+{
+    OutObjects.Reset();
+    SyncMovable();
+    GatherBox(FBox(Center - FVector(Radius), Center + FVector(Radius)), GatheredEntries);
+
+    for(int32 EntryIndex : GatheredEntries)
+    {
+        const FEntry &Entry = Entries[EntryIndex];
+        if(FVector::DistSquared(Center, Entry.Center) <= FMath::Square(Radius + Entry.Radius))
+        {
+            OutObjects.Add(Entry.Object);
+        }
+    }
+}
+
+void FHittableRegistry::QueryCone(const FConeQuery &Cone, TArray<AHittableObject*> &OutObjects)
+{
+    OutObjects.Reset();
+    SyncMovable();
+    GatherBox(FBox(Cone.Apex - FVector(Cone.Range), Cone.Apex + FVector(Cone.Range)), GatheredEntries);
+
+    // The cells only give a coarse answer, the packed cone test does the exact one.
+    GatheredBounds.Reset();
+    GatheredBounds.Reserve(GatheredEntries.Num());
+    for(int32 EntryIndex : GatheredEntries)
+    {
+        GatheredBounds.Add(Entries[EntryIndex].Center, Entries[EntryIndex].Radius);
+    }
+    GatheredBounds.CullToCone(Cone, Survivors);
+
+    for(int32 Index : Survivors)
+    {
+        OutObjects.Add(Entries[GatheredEntries[Index]].Object);
+    }
+}
+
+void FHittableRegistry::QueryFrustum(const FConvexVolume &Frustum, TArray<AHittableObject*> &OutObjects)
+{
+    OutObjects.Reset();
+    SyncMovable();
+
+    // A frustum has no cheap cell range, so every occupied cell is tested against it instead.
+    const FVector HalfCell(CellSize * 0.5f);
+    const FVector CellExtent = HalfCell + FVector(MaxRadius);
+    for(const auto &Cell : Cells)
+    {
+        const FVector CellCenter = FVector(Cell.Key) * CellSize + HalfCell;
+        if(!Frustum.IntersectBox(CellCenter, CellExtent)) { continue; }
+
+        for(int32 EntryIndex : Cell.Value)
+        {
+            const FEntry &Entry = Entries[EntryIndex];
+            if(Frustum.IntersectSphere(Entry.Center, Entry.Radius))
+            {
+                OutObjects.Add(Entry.Object);
+            }
+        }
+    }
+}
+
+FIntVector FHittableRegistry::GetCell(const FVector &Location) const
+{
+    return FIntVector(FMath::FloorToInt(Location.X / CellSize),
+                      FMath::FloorToInt(Location.Y / CellSize),
+                      FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void FHittableRegistry::AddToCell(int32 EntryIndex)
+{
+    Cells.FindOrAdd(Entries[EntryIndex].Cell).Add(EntryIndex);
+}
+
+void FHittableRegistry::RemoveFromCell(int32 EntryIndex)
+{
+    const FIntVector Cell = Entries[EntryIndex].Cell;
+    TArray<int32> *CellEntries = Cells.Find(Cell);
+    if(CellEntries)
+    {
+        CellEntries->RemoveSingleSwap(EntryIndex);
+        if(CellEntries->Num() == 0)
+        {
+            Cells.Remove(Cell);
+        }
+    }
+}
+
+void FHittableRegistry::UpdateEntry(int32 EntryIndex)
+{
+    FEntry &Entry = Entries[EntryIndex];
+    Entry.Center = Entry.Object->GetActorLocation();
+    Entry.Radius = Entry.Object->GetBeamRadius();
+    MaxRadius = FMath::Max(MaxRadius, Entry.Radius);
+
+    // Only touches the hash when the object actually crossed into another cell.
+    const FIntVector Cell = GetCell(Entry.Center);
+    if(Cell != Entry.Cell)
+    {
+        RemoveFromCell(EntryIndex);
+        Entry.Cell = Cell;
+        AddToCell(EntryIndex);
+    }
+}
+
+void FHittableRegistry::SyncMovable()
+{
+    // Movable objects are refreshed at most once a frame, and only when somebody asks.
+    if(LastSyncFrame == GFrameCounter) { return; }
+    LastSyncFrame = GFrameCounter;
+
+    for(int32 EntryIndex : MovableEntries)
+    {
+        UpdateEntry(EntryIndex);
+    }
+}
+
+void FHittableRegistry::GatherBox(const FBox &Box, TArray<int32> &OutEntries) const
+{
+    OutEntries.Reset();
+
+    const FIntVector Min = GetCell(Box.Min - FVector(MaxRadius));
+    const FIntVector Max = GetCell(Box.Max + FVector(MaxRadius));
+    const int64 CellCount = int64(Max.X - Min.X + 1) * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1);
+
+    // Large boxes over a sparse level are cheaper to answer by walking the occupied cells.
+    if(CellCount > Cells.Num())
+    {
+        for(const auto &Cell : Cells)
+        {
+            const FIntVector &Key = Cell.Key;
+            if(Key.X >= Min.X && Key.X <= Max.X && Key.Y >= Min.Y && Key.Y <= Max.Y && Key.Z >= Min.Z && Key.Z <= Max.Z)
+            {
+                OutEntries.Append(Cell.Value);
+            }
+        }
+        return;
+    }
+
+    for(int32 X = Min.X; X <= Max.X; X++)
+    {
+        for(int32 Y = Min.Y; Y <= Max.Y; Y++)
+        {
+            for(int32 Z = Min.Z; Z <= Max.Z; Z++)
+            {
+                const TArray<int32> *CellEntries = Cells.Find(FIntVector(X, Y, Z));
+                if(CellEntries)
+                {
+                    OutEntries.Append(*CellEntries);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ConeQuery.h"
+#include "LightsOutPerWorld.h"
+
+class AHittableObject;
+struct FConvexVolume;
+
+/**
+ * World-level registry of every AHittableObject in play, bucketed in a uniform spatial hash so
+ * sphere, cone and frustum queries only look at the cells they overlap instead of the physics scene.
+ * Objects join in BeginPlay and leave in EndPlay, the registry goes away with the world.
+ */
+class LIGHTSOUT_API FHittableRegistry
+{
+    public:
+
+        // Returns the registry for the world, creating it if needed.
+        static FHittableRegistry *Get(UWorld *World);
+        // Returns the registry for the world or nullptr if nothing has used it yet.
+        static FHittableRegistry *Find(const UWorld *World);
+
+        void Register(AHittableObject *Object);
+        void Unregister(AHittableObject *Object);
+        // Refreshes the object's bounds and moves it to its new cell if it changed.
+        void Update(AHittableObject *Object);
+
+        void QuerySphere(const FVector &Center, float Radius, TArray<AHittableObject*> &OutObjects);
+        void QueryCone(const FConeQuery &Cone, TArray<AHittableObject*> &OutObjects);
+        void QueryFrustum(const FConvexVolume &Frustum, TArray<AHittableObject*> &OutObjects);
+
+        int32 Num() const { return Entries.Num(); }
+
+    private:
+
+        struct FEntry
+        {
+            AHittableObject *Object;
+            FVector Center;
+            float Radius;
+            FIntVector Cell;
+            bool IsMovable;
+        };
+
+        friend class TLightsOutPerWorld<FHittableRegistry>;
+
+        explicit FHittableRegistry(const UWorld *InWorld);
+
+        FIntVector GetCell(const FVector &Location) const;
+        void AddToCell(int32 EntryIndex);
+        void RemoveFromCell(int32 EntryIndex);
+        void UpdateEntry(int32 EntryIndex);
+        void SyncMovable();
+        // Collects every entry in the cells overlapped by the box, padded by the largest radius.
+        void GatherBox(const FBox &Box, TArray<int32> &OutEntries) const;
+
+    private:
+
+        float CellSize;
+        float MaxRadius;
+        uint64 LastSyncFrame;
+
+        TSparseArray<FEntry> Entries;
+        TMap<FIntVector, TArray<int32>> Cells;
+        TArray<int32> MovableEntries;
+
+        // Scratch space reused between queries.
+        TArray<int32> GatheredEntries;
+        FPackedSpheres GatheredBounds;
+        TArray<int32> Survivors;
+};
@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "LightExposureGrid.h"
+
+static TAutoConsoleVariable<float> CVarExposureCellSize(
+    TEXT("LightsOut.Exposure.CellSize"),
+    100.0f,
+    TEXT("Size of a light exposure cell. Read when a world's grid is created."));
+
+static TAutoConsoleVariable<float> CVarExposureIntensityScale(
+    TEXT("LightsOut.Exposure.IntensityScale"),
+    0.0002f,
+    TEXT("Exposure per unit of light intensity reaching a cell."));
+
+// Contributions below this share of the light's intensity are left out, it keeps the falloff's long tail out of the grid.
+static const float MinContribution = 0.01f;
+
+FLightExposureGrid *FLightExposureGrid::Get(UWorld *World)
+{
+    return TLightsOutPerWorld<FLightExposureGrid>::Get(World);
+}
+
+FLightExposureGrid *FLightExposureGrid::Find(const UWorld *World)
+{
+    return TLightsOutPerWorld<FLightExposureGrid>::Find(World);
+}
+
+FLightExposureGrid::FLightExposureGrid(UWorld *InWorld)
+    : CellSize(FMath::Max(CVarExposureCellSize.GetValueOnGameThread(), 1.0f))
+{
+}
+
+void FLightExposureGrid::Register(UPointLightComponent *Light)
+{
+    if(Light == nullptr || Lights.Contains(Light)) { return; }
+
+    Lights.Add(Light);
+    States.AddDefaulted();
+    LightCells.AddDefaulted();
+    LightValues.AddDefaulted();
+
+    // Splatted on the next tick like any light that changed.
+}
+
+void FLightExposureGrid::Unregister(UPointLightComponent *Light)
+{
+    const int32 Index = Lights.IndexOfByKey(Light);
+    if(Index != INDEX_NONE)
+    {
+        RemoveAt(Index);
+    }
+}
+
+void FLightExposureGrid::RemoveAt(int32 Index)
+{
+    Apply(Index, -1.0f);
+    Lights.RemoveAtSwap(Index);
+    States.RemoveAtSwap(Index);
+    LightCells.RemoveAtSwap(Index);
+    LightValues.RemoveAtSwap(Index);
+}
+
+float FLightExposureGrid::GetExposure(const FVector &Location) const
+{
+    const float *Exposure = Cells.Find(GetCellKey(Location));
+    return Exposure ? FMath::Max(*Exposure, 0.0f) * CVarExposureIntensityScale.GetValueOnGameThread() : 0.0f;
+}
+
+void FLightExposureGrid::Tick(float DeltaTime)
+{
+    for(int32 Index = Lights.Num() - 1; Index >= 0; Index--)
+    {
+        const UPointLightComponent *Light = Lights[Index].Get();
+        if(Light == nullptr)
+        {
+            RemoveAt(Index);
+            continue;
+        }
+
+        const FLightState State = GetState(Light);
+        if(!HasChanged(States[Index], State)) { continue; }
+
+        Apply(Index, -1.0f);
+        States[Index] = State;
+        Rasterize(Index);
+        Apply(Index, 1.0f);
+    }
+}
+
+FLightExposureGrid::FLightState FLightExposureGrid::GetState(const UPointLightComponent *Light) const
+{
+    FLightState State;
+    State.Location = Light->GetComponentLocation();
+    State.Direction = Light->GetForwardVector();
+    State.Intensity = Light->IsRegistered() ? Light->Intensity : 0.0f;
+    State.Radius = Light->AttenuationRadius;
+
+    const USpotLightComponent *SpotLight = Cast<const USpotLightComponent>(Light);
+    if(SpotLight)
+    {
+        const float OuterCone = FMath::Clamp(SpotLight->OuterConeAngle, 0.0f, 89.0f);
+        State.CosOuterCone = FMath::Cos(FMath::DegreesToRadians(OuterCone));
+        State.CosInnerCone = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(SpotLight->InnerConeAngle, 0.0f, OuterCone)));
+    }
+    return State;
+}
+
+// Small changes are ignored, they would not move the light by a noticeable share of a cell.
+bool FLightExposureGrid::HasChanged(const FLightState &Old, const FLightState &New) const
+{
+    if((Old.Intensity > 0) != (New.Intensity > 0)) { return true; }
+    if(New.Intensity <= 0) { return false; }
+
+    return FVector::DistSquared(Old.Location, New.Location) > FMath::Square(CellSize * 0.1f) ||
+        (New.CosOuterCone > -1 && (Old.Direction | New.Direction) < 0.9995f) ||
+        FMath::Abs(Old.Intensity - New.Intensity) > Old.Intensity * 0.01f ||
+        FMath::Abs(Old.Radius - New.Radius) > CellSize * 0.1f ||
+        Old.CosInnerCone != New.CosInnerCone || Old.CosOuterCone != New.CosOuterCone;
+}
+
+// Works out the light's share of every cell it reaches, without touching the grid yet.
+void FLightExposureGrid::Rasterize(int32 Index)
+{
+    const FLightState &State = States[Index];
+    TArray<uint64> &Keys = LightCells[Index];
+    TArray<float> &Values = LightValues[Index];
+    Keys.Reset();
+    Values.Reset();
+    if(State.Intensity <= 0 || State.Radius <= 0) { return; }
+
+    // A spot light only needs the box around its cone, the apex and the circle at its far end.
+    const bool IsSpot = State.CosOuterCone > -1;
+    FBox Bounds(State.Location - FVector(State.Radius), State.Location + FVector(State.Radius));
+    if(IsSpot)
+    {
+        const FVector End = State.Location + State.Direction * State.Radius;
+        const float EndRadius = State.Radius * FMath::Sqrt(1.0f - FMath::Square(State.CosOuterCone)) / FMath::Max(State.CosOuterCone, KINDA_SMALL_NUMBER);
+        const FVector Extent(
+            EndRadius * FMath::Sqrt(FMath::Max(1.0f - FMath::Square(State.Direction.X), 0.0f)),
+            EndRadius * FMath::Sqrt(FMath::Max(1.0f - FMath::Square(State.Direction.Y), 0.0f)),
+            EndRadius * FMath::Sqrt(FMath::Max(1.0f - FMath::Square(State.Direction.Z), 0.0f)));
+        Bounds = FBox(State.Location, State.Location) + FBox(End - Extent, End + Extent);
+        Bounds.Min = Bounds.Min.ComponentMax(State.Location - FVector(State.Radius));
+        Bounds.Max = Bounds.Max.ComponentMin(State.Location + FVector(State.Radius));
+    }
+
+    const FIntVector Min(FMath::FloorToInt(Bounds.Min.X / CellSize), FMath::FloorToInt(Bounds.Min.Y / CellSize), FMath::FloorToInt(Bounds.Min.Z / CellSize));
+    const FIntVector Max(FMath::FloorToInt(Bounds.Max.X / CellSize), FMath::FloorToInt(Bounds.Max.Y / CellSize), FMath::FloorToInt(Bounds.Max.Z / CellSize));
+    const float InvRadiusSquared = 1.0f / FMath::Square(State.Radius);
+    const float ConeRange = FMath::Max(State.CosInnerCone - State.CosOuterCone, KINDA_SMALL_NUMBER);
+
+    for(int32 Z = Min.Z; Z <= Max.Z; Z++)
+    {
+        for(int32 Y = Min.Y; Y <= Max.Y; Y++)
+        {
+            for(int32 X = Min.X; X <= Max.X; X++)
+            {
+                const FVector ToCell = FVector(X + 0.5f, Y + 0.5f, Z + 0.5f) * CellSize - State.Location;
+                const float DistanceSquared = ToCell.SizeSquared();
+
+                // The same smooth window the renderer fades inverse squared lights out with.
+                float Falloff = FMath::Square(FMath::Max(1.0f - DistanceSquared * InvRadiusSquared, 0.0f));
+                if(IsSpot && DistanceSquared > KINDA_SMALL_NUMBER)
+                {
+                    const float CosAngle = (ToCell | State.Direction) * FMath::InvSqrt(DistanceSquared);
+                    Falloff *= FMath::Clamp((CosAngle - State.CosOuterCone) / ConeRange, 0.0f, 1.0f);
+                }
+                if(Falloff < MinContribution) { continue; }
+
+                Keys.Add(GetCellKey(X, Y, Z));
+                Values.Add(State.Intensity * Falloff);
+            }
+        }
+    }
+}
+
+// Adds or takes away the light's last contribution. Cells nothing reaches any more are dropped.
+void FLightExposureGrid::Apply(int32 Index, float Sign)
+{
+    const TArray<uint64> &Keys = LightCells[Index];
+    const TArray<float> &Values = LightValues[Index];
+    for(int32 Cell = 0; Cell < Keys.Num(); Cell++)
+    {
+        float &Exposure = Cells.FindOrAdd(Keys[Cell]);
+        Exposure += Sign * Values[Cell];
+        if(Sign < 0 && Exposure <= KINDA_SMALL_NUMBER)
+        {
+            Cells.Remove(Keys[Cell]);
+        }
+    }
+}
+
+uint64 FLightExposureGrid::GetCellKey(const FVector &Location) const
+{
+    return GetCellKey(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
+
+// Packs the cell's coordinates into 21 bits each, which covers far more than any level.
+uint64 FLightExposureGrid::GetCellKey(int32 X, int32 Y, int32 Z)
+{
+    return ((uint64(X) & 0x1FFFFF) << 42) | ((uint64(Y) & 0x1FFFFF) << 21) | (uint64(Z) & 0x1FFFFF);
+}
+
+TStatId FLightExposureGrid::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(FLightExposureGrid, STATGROUP_Tickables);
+}
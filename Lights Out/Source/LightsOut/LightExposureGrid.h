@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Tickable.h"
+#include "LightsOutPerWorld.h"
+
+/**
+ * Coarse grid of how much light reaches each part of the level, for gameplay that asks how lit a
+ * location is. Every registered point or spot light adds its falloff to the cells it reaches, and
+ * only the lights that moved or changed since the last frame take theirs out and add it again, so a
+ * still level costs nothing to keep up to date. Looking a location up is one hash lookup. Walls do
+ * not stop the light, the grid is meant for broad questions like whether an area is dark.
+ */
+class LIGHTSOUT_API FLightExposureGrid : public FTickableGameObject
+{
+    public:
+
+        // Returns the grid for the world, creating it if needed.
+        static FLightExposureGrid *Get(UWorld *World);
+        // Returns the grid for the world or nullptr if nothing has used it yet.
+        static FLightExposureGrid *Find(const UWorld *World);
+
+        // Adds a point light, spot lights only light the cells inside their cone.
+        void Register(UPointLightComponent *Light);
+        void Unregister(UPointLightComponent *Light);
+
+        // Light reaching the cell holding the location, 0 in the dark and around 1 next to a lit gem.
+        float GetExposure(const FVector &Location) const;
+
+        // FTickableGameObject interface
+        virtual void Tick(float DeltaTime) override;
+        virtual bool IsTickable() const override { return Lights.Num() > 0; }
+        virtual TStatId GetStatId() const override;
+
+    private:
+
+        // What a light's contribution was last built from.
+        struct FLightState
+        {
+            FVector Location = FVector::ZeroVector;
+            FVector Direction = FVector::ZeroVector;
+            float Intensity = 0;
+            float Radius = 0;
+            float CosInnerCone = -1;
+            float CosOuterCone = -1;
+        };
+
+        friend class TLightsOutPerWorld<FLightExposureGrid>;
+
+        explicit FLightExposureGrid(UWorld *InWorld);
+
+        FLightState GetState(const UPointLightComponent *Light) const;
+        bool HasChanged(const FLightState &Old, const FLightState &New) const;
+        void Rasterize(int32 Index);
+        void Apply(int32 Index, float Sign);
+        void RemoveAt(int32 Index);
+        uint64 GetCellKey(const FVector &Location) const;
+        static uint64 GetCellKey(int32 X, int32 Y, int32 Z);
+
+    private:
+
+        float CellSize;
+
+        // Parallel arrays, one entry per registered light, with the cells it last added to.
+        TArray<TWeakObjectPtr<UPointLightComponent>> Lights;
+        TArray<FLightState> States;
+        TArray<TArray<uint64>> LightCells;
+        TArray<TArray<float>> LightValues;
+
+        // Summed contributions of every cell some light reaches.
+        TMap<uint64, float> Cells;
+};
@@ -7,5 +7,6 @@ public class LightsOut : ModuleRules
 	public LightsOut(TargetInfo Target)
 	{
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore" });
+		PrivateDependencyModuleNames.AddRange(new string[] { "Json", "MoviePlayer", "Slate", "SlateCore" });
 	}
 }
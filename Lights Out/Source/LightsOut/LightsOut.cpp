@@ -3,5 +3,7 @@
 #include "LightsOut.h"
 
 
+DEFINE_LOG_CATEGORY(LogLightsOut);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, LightsOut, "LightsOut" );
  
\ No newline at end of file
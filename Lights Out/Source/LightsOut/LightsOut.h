@@ -5,5 +5,13 @@
 
 #include "EngineMinimal.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogLightsOut, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("LightsOut"), STATGROUP_LightsOut, STATCAT_Advanced);
+
+// Trace channel of the flashlight beam, see DefaultEngine.ini. Only light proxies and the level's
+// blocking geometry respond to it.
+#define COLLISION_FLASHLIGHT ECC_GameTraceChannel2
+
 
 #endif
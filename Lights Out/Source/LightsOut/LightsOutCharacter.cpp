@@ -4,16 +4,25 @@
 #include "Flashlight.h"
 #include "LightsOutCharacter.h"
 #include "LightsOutProjectile.h"
+#include "ProjectilePool.h"
+#include "LightsOutMovementComponent.h"
+#include "LightsOutGameInstance.h"
+#include "LightsOutInputCapture.h"
 #include "Animation/AnimInstance.h"
 #include "GameFramework/InputSettings.h"
+#include "UnrealNetwork.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
 //////////////////////////////////////////////////////////////////////////
 // ALightsOutCharacter
 
-ALightsOutCharacter::ALightsOutCharacter()
+ALightsOutCharacter::ALightsOutCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<ULightsOutMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
+	// Movement and camera components tick on their own, the character itself has nothing to do per frame
+	PrimaryActorTick.bCanEverTick = false;
+
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
 
@@ -47,18 +56,25 @@ ALightsOutCharacter::ALightsOutCharacter()
 
 	// Note: The ProjectileClass and the skeletal mesh/anim blueprints for Mesh1P are set in the
 	// derived blueprint asset named MyCharacter (to avoid direct content references in C++)
+}
+
+void ALightsOutCharacter::PostLoad()
+{
+    Super::PostLoad();
     
-    //initializing the speed of the character
-    mDefaultSpeed = this->GetCharacterMovement()->MaxWalkSpeed;
-    mMaxSpeed = mDefaultSpeed * mMaxSpeedMulti;
-    mCurrentSpeed = mDefaultSpeed;
+    ULightsOutGameInstance::MigrateReference(FireSound_DEPRECATED, FireSoundAsset);
+    ULightsOutGameInstance::MigrateReference(FlashlightClass_DEPRECATED, FlashlightClassAsset);
 }
 
 void ALightsOutCharacter::BeginPlay()
 {
     Super::BeginPlay();
     
-    if(FlashlightClass)
+    ULightsOutGameInstance::RequestAsyncLoad(this, { FireSoundAsset.ToStringReference() });
+    
+    // The server spawns the flashlight and replicates it, clients attach it when it arrives.
+    UClass *LoadedFlashlightClass = Role == ROLE_Authority ? ULightsOutGameInstance::Resolve(this, FlashlightClassAsset) : nullptr;
+    if(LoadedFlashlightClass)
     {
         UWorld *World = GetWorld();
         if(World)
@@ -68,19 +84,27 @@ void ALightsOutCharacter::BeginPlay()
             SpawnParameters.Instigator = Instigator;
             
             FRotator Rotation(0.0f, 0.0f, 0.0f);
-            Flashlight = World->SpawnActor<AFlashlight>(FlashlightClass, FVector(0, 0, 0), Rotation, SpawnParameters);
-            if(Flashlight)
-            {
-                Flashlight->GetFlashlightMesh()->AttachTo(Mesh1P, TEXT("GripPoint"), EAttachLocation::SnapToTargetIncludingScale, true);
-                Flashlight->SetMyOwner(this);
-            }
+            Flashlight = World->SpawnActor<AFlashlight>(LoadedFlashlightClass, FVector(0, 0, 0), Rotation, SpawnParameters);
+            AttachFlashlight();
         }
     }
+    
+    if(ProjectileClass != NULL)
+    {
+        ProjectilePool = NewObject<UProjectilePool>(this);
+        ProjectilePool->Initialize(this, ProjectileClass, ProjectilePoolSize, MaxProjectilePoolSize);
+    }
 }
 
-void ALightsOutCharacter::Tick(float DeltaTime)
+void ALightsOutCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    Super::Tick(DeltaTime);
+    if(ProjectilePool)
+    {
+        ProjectilePool->LogStats();
+        ProjectilePool->Empty();
+    }
+    
+    Super::EndPlay(EndPlayReason);
 }
 
 void ALightsOutCharacter::SetupPlayerInputComponent(class UInputComponent* InputComponent)
@@ -103,61 +127,37 @@ void ALightsOutCharacter::SetupPlayerInputComponent(class UInputComponent* Input
     
     InputComponent->BindAction("FlashlightToggle", IE_Pressed, this, &ALightsOutCharacter::OnToggleFlashlight);
     InputComponent->BindAxis("FocusFlashlight", this, &ALightsOutCharacter::OnFocusFlashlight);
+    
+    // Records the session through these bindings, or plays a recording back into them
+    FLightsOutInputCapture::Bind(this, InputComponent);
 }
+// Sprint speed is handled by the movement component, which changes it smoothly every movement update.
 void ALightsOutCharacter::OnWalk()
 {
-    GetWorldTimerManager().ClearTimer(RunTimer);
-    GetWorldTimerManager().SetTimer(WalkTimer, this, &ALightsOutCharacter::PlayerWalk, TimerRate, true);
+    CastChecked<ULightsOutMovementComponent>(GetCharacterMovement())->SetSprinting(false);
 }
 void ALightsOutCharacter::OnRun()
 {
-    GetWorldTimerManager().ClearTimer(WalkTimer);
-    GetWorldTimerManager().SetTimer(RunTimer, this, &ALightsOutCharacter::PlayerRun, TimerRate, true);
-}
-void ALightsOutCharacter::PlayerRun()
-{
-    if(GetInputAxisValue("MoveForward") != 0 || GetInputAxisValue("MoveRight") != 0)
-    {
-        mCurrentSpeed += mCurrentSpeed/10.0f;
-        mCurrentSpeed = FMath::Clamp(mCurrentSpeed, mDefaultSpeed, mMaxSpeed);
-    }
-    else
-    {
-        mCurrentSpeed = mDefaultSpeed;
-    }
-    this->GetCharacterMovement()->MaxWalkSpeed = mCurrentSpeed;
-}
-void ALightsOutCharacter::PlayerWalk()
-{
-    mCurrentSpeed -= mCurrentSpeed/20.0f;
-    mCurrentSpeed = FMath::Clamp(mCurrentSpeed, mDefaultSpeed, mMaxSpeed);
-    this->GetCharacterMovement()->MaxWalkSpeed = mCurrentSpeed;
-    if(mCurrentSpeed == mDefaultSpeed)
-    {
-        GetWorldTimerManager().ClearTimer(WalkTimer);
-    }
+    CastChecked<ULightsOutMovementComponent>(GetCharacterMovement())->SetSprinting(true);
 }
 void ALightsOutCharacter::OnFire()
 { 
 	// try and fire a projectile
-	if (ProjectileClass != NULL)
+	if (ProjectilePool != NULL)
 	{
 		const FRotator SpawnRotation = GetControlRotation();
 		// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
 		const FVector SpawnLocation = GetActorLocation() + SpawnRotation.RotateVector(GunOffset);
 
-		UWorld* const World = GetWorld();
-		if (World != NULL)
-		{
-			// spawn the projectile at the muzzle
-			World->SpawnActor<ALightsOutProjectile>(ProjectileClass, SpawnLocation, SpawnRotation);
-		}
+		// launch a pooled projectile from the muzzle
+		ProjectilePool->Fire(SpawnLocation, SpawnRotation);
 	}
 
 	// try and play the sound if specified
-	if (FireSound != NULL)
+	USoundBase* LoadedFireSound = ULightsOutGameInstance::Resolve(this, FireSoundAsset);
+	if (LoadedFireSound != NULL)
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+		UGameplayStatics::PlaySoundAtLocation(this, LoadedFireSound, GetActorLocation());
 	}
 
 	// try and play a firing animation if specified
@@ -232,7 +232,49 @@ void ALightsOutCharacter::TouchUpdate(const ETouchIndex::Type FingerIndex, const
 	}
 }
 
+void ALightsOutCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+    
+    DOREPLIFETIME(ALightsOutCharacter, Flashlight);
+}
+
+void ALightsOutCharacter::OnRep_Flashlight()
+{
+    AttachFlashlight();
+}
+
+void ALightsOutCharacter::AttachFlashlight()
+{
+    if(Flashlight)
+    {
+        Flashlight->GetFlashlightMesh()->AttachTo(Mesh1P, TEXT("GripPoint"), EAttachLocation::SnapToTargetIncludingScale, true);
+        Flashlight->SetMyOwner(this);
+    }
+}
+
 void ALightsOutCharacter::OnToggleFlashlight()
+{
+    ServerToggleFlashlight();
+}
+
+void ALightsOutCharacter::OnFocusFlashlight(float axis)
+{
+    // The axis is bound every frame, so only changes in direction are sent.
+    const int8 Direction = int8(FMath::Clamp(FMath::RoundToInt(axis * 127.0f), -127, 127));
+    if(Direction != FocusDirection)
+    {
+        FocusDirection = Direction;
+        ServerFocusFlashlight(Direction);
+    }
+}
+
+bool ALightsOutCharacter::ServerToggleFlashlight_Validate()
+{
+    return true;
+}
+
+void ALightsOutCharacter::ServerToggleFlashlight_Implementation()
 {
     if(Flashlight)
     {
@@ -240,11 +282,16 @@ void ALightsOutCharacter::OnToggleFlashlight()
     }
 }
 
-void ALightsOutCharacter::OnFocusFlashlight(float axis)
+bool ALightsOutCharacter::ServerFocusFlashlight_Validate(int8 Direction)
+{
+    return Direction >= -127;
+}
+
+void ALightsOutCharacter::ServerFocusFlashlight_Implementation(int8 Direction)
 {
     if(Flashlight)
     {
-        Flashlight->SetLerp(axis);
+        Flashlight->SetLerp(Direction / 127.0f);
     }
 }
 
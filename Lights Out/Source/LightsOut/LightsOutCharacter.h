@@ -22,11 +22,12 @@ class ALightsOutCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FirstPersonCameraComponent;
 public:
-	ALightsOutCharacter();
+	ALightsOutCharacter(const FObjectInitializer& ObjectInitializer);
     
+    virtual void PostLoad() override;
     virtual void BeginPlay() override;
-    
-    virtual void Tick(float DeltaTime) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
@@ -44,9 +45,21 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category=Projectile)
 	TSubclassOf<class ALightsOutProjectile> ProjectileClass;
 
-	/** Sound to play each time we fire */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
-	class USoundBase* FireSound;
+	/** Number of projectiles spawned up front for the projectile pool */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	int32 ProjectilePoolSize = 16;
+
+	/** Most projectiles the pool will ever hold, the oldest one in flight is recycled past that */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	int32 MaxProjectilePoolSize = 64;
+
+	/** Sound to play each time we fire, loaded in the background when the character spawns */
+	UPROPERTY(EditAnywhere, Category=Gameplay)
+	TAssetPtr<class USoundBase> FireSoundAsset;
+
+	/** Hard reference from before the sound was loaded softly, moved over in PostLoad() */
+	UPROPERTY()
+	class USoundBase* FireSound_DEPRECATED;
 
 	/** AnimMontage to play each time we fire */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
@@ -57,6 +70,10 @@ protected:
 	/** Fires a projectile. */
 	void OnFire();
 
+	/** Recycles fired projectiles */
+	UPROPERTY(Transient)
+	class UProjectilePool* ProjectilePool;
+
 	/** Handles moving forward/backward */
 	void MoveForward(float Val);
 
@@ -111,32 +128,33 @@ public:
 public:
     void OnRun();
     void OnWalk();
-    void PlayerRun();
-    void PlayerWalk();
     
     void OnToggleFlashlight();
     void OnFocusFlashlight(float focus);
     
     class AFlashlight* GetFlashlight(){return Flashlight;};
 protected:
-    //Maximum speed multiplier
-    UPROPERTY(EditAnywhere, Category = Speed)
-    float mMaxSpeedMulti = 4.0f;
-    UPROPERTY(EditAnywhere)
-    float mCurrentSpeed;
-    float TimerRate = 0.1f;
+    //The flashlight is driven by the server, input is sent to it through these
+    UFUNCTION(Server, Reliable, WithValidation)
+    void ServerToggleFlashlight();
+    UFUNCTION(Server, Reliable, WithValidation)
+    void ServerFocusFlashlight(int8 Direction);
+    
+    UFUNCTION()
+    void OnRep_Flashlight();
+    void AttachFlashlight();
     
     UPROPERTY(EditAnywhere, Category = Flashlight)
-    TSubclassOf<class AFlashlight> FlashlightClass;
+    TAssetSubclassOf<class AFlashlight> FlashlightClassAsset;
     
-    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item)
+    // Hard reference from before the class was loaded softly, moved over in PostLoad().
+    UPROPERTY()
+    TSubclassOf<class AFlashlight> FlashlightClass_DEPRECATED;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_Flashlight, Category = Item)
     class AFlashlight *Flashlight;
 private:
-    //Changing the intital speed of the player can be done from MaxWalkSpeed in Character Movement.
-    float mDefaultSpeed;
-    float mMaxSpeed;
-    FTimerHandle RunTimer;
-    FTimerHandle WalkTimer;
-
+    //Focus input last sent to the server, so the axis only costs an RPC when it changes
+    int8 FocusDirection = 0;
 };
 
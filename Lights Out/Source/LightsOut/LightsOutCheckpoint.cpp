@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "LightsOutCheckpoint.h"
+#include "Flashlight.h"
+#include "PuzzleManager.h"
+#include "LightsOutPerf.h"
+#include "EngineUtils.h"
+
+// Bumped whenever the layout below changes, older files are then discarded instead of misread.
+static const uint32 CheckpointMagic = 0x50434F4C;
+static const int32 CheckpointVersion = 3;
+
+// The latest packed checkpoint waiting to be written, and whether a save task is already running.
+// Only one task writes at a time and it always finishes on the newest checkpoint, so two rooms
+// solved close together can never leave the older one on disk.
+static FCriticalSection PendingSaveLock;
+static TArray<uint8> PendingSaveData;
+static FString PendingSaveFilename;
+static bool HasPendingSave = false;
+static bool IsSaveRunning = false;
+
+// Writes packed checkpoints to disk on the thread pool until none are left waiting.
+class FCheckpointSaveTask : public FNonAbandonableTask
+{
+    public:
+
+        void DoWork()
+        {
+            for(;;)
+            {
+                TArray<uint8> Data;
+                FString Filename;
+                {
+                    FScopeLock Lock(&PendingSaveLock);
+                    if(!HasPendingSave)
+                    {
+                        IsSaveRunning = false;
+                        return;
+                    }
+                    Exchange(Data, PendingSaveData);
+                    Filename = PendingSaveFilename;
+                    HasPendingSave = false;
+                }
+
+                // The save is replaced in one move, so a crash mid-write leaves the previous one intact.
+                const FString TempFilename = Filename + TEXT(".tmp");
+                if(!FFileHelper::SaveArrayToFile(Data, *TempFilename) || !IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+                {
+                    UE_LOG(LogLightsOut, Warning, TEXT("Could not write the checkpoint to %s"), *Filename);
+                }
+            }
+        }
+
+        FORCEINLINE TStatId GetStatId() const
+        {
+            RETURN_QUICK_DECLARE_CYCLE_STAT(FCheckpointSaveTask, STATGROUP_ThreadPoolAsyncTasks);
+        }
+};
+
+void FLightsOutCheckpoint::Capture(UWorld *World)
+{
+    LIGHTSOUT_SCOPE(SaveCheckpoint);
+
+    for(TActorIterator<AFlashlight> It(World); It; ++It)
+    {
+        BatteryLife = It->GetBatteryTime();
+        FocusPercentage = It->GetFocusPercentage();
+        break;
+    }
+
+    // The players are standing in the room that was just solved, which is where they come back to.
+    Players.Reset();
+    for(FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        FPlayerCheckpoint &Player = Players[Players.AddDefaulted()];
+        APawn *Pawn = *It ? (*It)->GetPawn() : nullptr;
+        if(Pawn)
+        {
+            Player.Location = Pawn->GetActorLocation();
+            Player.Rotation = (*It)->GetControlRotation();
+            Player.HasPawn = true;
+        }
+    }
+
+    for(TActorIterator<APuzzleManager> It(World); It; ++It)
+    {
+        const FName Room = It->GetFName();
+        FPuzzleCheckpoint *Puzzle = Puzzles.FindByPredicate([Room](const FPuzzleCheckpoint &Saved) { return Saved.Room == Room; });
+        if(Puzzle == nullptr)
+        {
+            Puzzle = &Puzzles[Puzzles.AddDefaulted()];
+            Puzzle->Room = Room;
+        }
+        It->SaveCheckpoint(*Puzzle);
+    }
+    HasData = true;
+}
+
+bool FLightsOutCheckpoint::Restore(UWorld *World) const
+{
+    if(!HasData) { return false; }
+
+    LIGHTSOUT_SCOPE(RestoreCheckpoint);
+
+    for(TActorIterator<AFlashlight> It(World); It; ++It)
+    {
+        It->RestoreCheckpoint(BatteryLife, FocusPercentage);
+    }
+
+    int32 PlayerIndex = 0;
+    for(FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It && PlayerIndex < Players.Num(); ++It, PlayerIndex++)
+    {
+        const FPlayerCheckpoint &Player = Players[PlayerIndex];
+        APawn *Pawn = *It ? (*It)->GetPawn() : nullptr;
+        if(Pawn == nullptr || !Player.HasPawn) { continue; }
+
+        if(Pawn->GetMovementComponent())
+        {
+            Pawn->GetMovementComponent()->StopMovementImmediately();
+        }
+        Pawn->TeleportTo(Player.Location, FRotator(0, Player.Rotation.Yaw, 0));
+        (*It)->SetControlRotation(Player.Rotation);
+    }
+    for(TActorIterator<APuzzleManager> It(World); It; ++It)
+    {
+        RestorePuzzle(*It);
+    }
+    return true;
+}
+
+void FLightsOutCheckpoint::RestorePuzzle(APuzzleManager *Puzzle) const
+{
+    const FPuzzleCheckpoint *Saved = FindPuzzle(Puzzle->GetFName());
+    Puzzle->RestoreCheckpoint(Saved ? *Saved : FPuzzleCheckpoint());
+}
+
+const FPuzzleCheckpoint *FLightsOutCheckpoint::FindPuzzle(FName Room) const
+{
+    return Puzzles.FindByPredicate([Room](const FPuzzleCheckpoint &Saved) { return Saved.Room == Room; });
+}
+
+void FLightsOutCheckpoint::SaveAsync(const FString &Filename)
+{
+    if(!HasData) { return; }
+
+    TArray<uint8> Data;
+    FMemoryWriter Writer(Data);
+    Serialize(Writer);
+
+    FScopeLock Lock(&PendingSaveLock);
+    Exchange(PendingSaveData, Data);
+    PendingSaveFilename = Filename;
+    HasPendingSave = true;
+    if(!IsSaveRunning)
+    {
+        IsSaveRunning = true;
+        (new FAutoDeleteAsyncTask<FCheckpointSaveTask>())->StartBackgroundTask();
+    }
+}
+
+bool FLightsOutCheckpoint::Load(const FString &Filename)
+{
+    TArray<uint8> Data;
+    if(!FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent)) { return false; }
+
+    FLightsOutCheckpoint Loaded;
+    FMemoryReader Reader(Data);
+    if(!Loaded.Serialize(Reader))
+    {
+        UE_LOG(LogLightsOut, Warning, TEXT("Ignoring the checkpoint in %s, it is corrupt or from another version"), *Filename);
+        return false;
+    }
+
+    Loaded.HasData = true;
+    *this = Loaded;
+    return true;
+}
+
+bool FLightsOutCheckpoint::Serialize(FArchive &Ar)
+{
+    uint32 Magic = CheckpointMagic;
+    int32 Version = CheckpointVersion;
+    Ar << Magic << Version;
+    if(Ar.IsLoading() && (Magic != CheckpointMagic || Version != CheckpointVersion))
+    {
+        return false;
+    }
+
+    Ar << BatteryLife << FocusPercentage << Players << Puzzles;
+    return !Ar.IsError();
+}
+
+FString FLightsOutCheckpoint::GetDefaultFilename()
+{
+    return FPaths::GameSavedDir() / TEXT("SaveGames") / TEXT("Checkpoint.sav");
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// A puzzle room as it was when the checkpoint was taken, in the same packed form it replicates in.
+struct FPuzzleCheckpoint
+{
+    FName Room;
+    int32 PuzzleState = 0;
+    uint32 PuzzleBits = 0;
+
+    friend FArchive &operator<<(FArchive &Ar, FPuzzleCheckpoint &Puzzle)
+    {
+        return Ar << Puzzle.Room << Puzzle.PuzzleState << Puzzle.PuzzleBits;
+    }
+};
+
+// Where one player stood and looked when the checkpoint was taken.
+struct FPlayerCheckpoint
+{
+    FVector Location = FVector::ZeroVector;
+    FRotator Rotation = FRotator::ZeroRotator;
+    bool HasPawn = false;
+
+    friend FArchive &operator<<(FArchive &Ar, FPlayerCheckpoint &Player)
+    {
+        return Ar << Player.Location << Player.Rotation << Player.HasPawn;
+    }
+};
+
+/**
+ * The flashlight, where the players stood and every puzzle room they have been through, as they were
+ * when the last room was solved. It is held in memory as plain values, so going back to it costs a
+ * few assignments per room, and is written to disk as a small versioned blob from a worker thread.
+ */
+class LIGHTSOUT_API FLightsOutCheckpoint
+{
+    public:
+
+        bool IsValid() const { return HasData; }
+
+        // Records the world's flashlight, every player's position and the loaded rooms. Rooms in
+        // levels that are streamed out keep whatever was recorded for them last time.
+        void Capture(UWorld *World);
+
+        // Puts the world's flashlights and loaded rooms back and moves each player to where they
+        // stood. Returns false if nothing was captured yet.
+        bool Restore(UWorld *World) const;
+
+        // Puts one room back, rooms the checkpoint never saw start over.
+        void RestorePuzzle(class APuzzleManager *Puzzle) const;
+
+        // Writes the checkpoint from a worker thread, the game thread only packs it. Saves made while
+        // an earlier one is still being written replace it in the queue rather than racing it.
+        void SaveAsync(const FString &Filename);
+
+        // Reads a checkpoint written by an earlier session. Files from another version are ignored.
+        bool Load(const FString &Filename);
+
+        static FString GetDefaultFilename();
+
+    private:
+
+        bool Serialize(FArchive &Ar);
+        const FPuzzleCheckpoint *FindPuzzle(FName Room) const;
+
+    private:
+
+        float BatteryLife = 0;
+        float FocusPercentage = 0;
+        // One per player controller, in the order the world lists them, which for splitscreen is
+        // the order the local players joined in.
+        TArray<FPlayerCheckpoint> Players;
+        TArray<FPuzzleCheckpoint> Puzzles;
+        bool HasData = false;
+};
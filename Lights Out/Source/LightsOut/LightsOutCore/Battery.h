@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Battery drain, free of any engine types so it can be built and checked without the editor.
+namespace LightsOutCore
+{
+    // Returns the battery life left after draining at Rate for DeltaTime seconds.
+    inline float DrainBattery(float Life, float DeltaTime, float Rate)
+    {
+        return Life - DeltaTime * Rate;
+    }
+
+    // Returns the battery life after adding Time, never going past MaxLife.
+    inline float AddBattery(float Life, float Time, float MaxLife)
+    {
+        Life += Time;
+        return Life > MaxLife ? MaxLife : Life;
+    }
+
+    inline bool IsBatteryDead(float Life)
+    {
+        return Life <= 0.0f;
+    }
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOutCore/FlashlightModel.h"
+#include "LightsOutCore/PuzzleModel.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace LightsOutCore;
+
+static void BM_FlashlightCurveEvaluate(benchmark::State &State)
+{
+    FlashlightLimits Limits = { 1.0f, 5.0f, 10.0f, 50.0f, 1000.0f, 5000.0f, 500.0f, 2500.0f };
+    FlashlightCurve Curve;
+    Curve.Build(Limits, int(State.range(0)));
+
+    float Percentage = 0.0f;
+    for(auto _ : State)
+    {
+        benchmark::DoNotOptimize(Curve.Evaluate(Percentage));
+        Percentage = Percentage >= 100.0f ? 0.0f : Percentage + 0.37f;
+    }
+}
+BENCHMARK(BM_FlashlightCurveEvaluate)->Arg(17)->Arg(257);
+
+// The direct evaluation the curve replaces, for comparison.
+static void BM_FlashlightLerp(benchmark::State &State)
+{
+    FlashlightLimits Limits = { 1.0f, 5.0f, 10.0f, 50.0f, 1000.0f, 5000.0f, 500.0f, 2500.0f };
+
+    float Percentage = 0.0f;
+    for(auto _ : State)
+    {
+        benchmark::DoNotOptimize(LerpFlashlight(Limits, Percentage));
+        Percentage = Percentage >= 100.0f ? 0.0f : Percentage + 0.37f;
+    }
+}
+BENCHMARK(BM_FlashlightLerp);
+
+// Plays random gems against a puzzle with the given number of patterns, eight gems long each.
+static void BM_PuzzleAdvance(benchmark::State &State)
+{
+    const int NumPatterns = int(State.range(0));
+    const int NumGems = 16;
+
+    std::vector<std::vector<int>> Patterns(NumPatterns);
+    uint32_t Seed = 12345;
+    for(std::vector<int> &Pattern : Patterns)
+    {
+        for(int Index = 0; Index < 8; Index++)
+        {
+            Seed = Seed * 1664525u + 1013904223u;
+            Pattern.push_back(int(Seed >> 16) % NumGems);
+        }
+    }
+
+    CompiledPuzzle Puzzle;
+    CompilePuzzle(Patterns, true, Puzzle);
+
+    std::vector<int> Gems(1024);
+    for(int &GemId : Gems)
+    {
+        Seed = Seed * 1664525u + 1013904223u;
+        GemId = int(Seed >> 16) % NumGems;
+    }
+
+    int PuzzleState = 0;
+    std::size_t Next = 0;
+    for(auto _ : State)
+    {
+        const uint16_t Transition = AdvancePuzzle(Puzzle.Transitions.data(), Puzzle.NumGems, Puzzle.MismatchTransition, PuzzleState, Gems[Next]);
+        PuzzleState = Transition & PuzzleStateMask;
+        Next = (Next + 1) & (Gems.size() - 1);
+        benchmark::DoNotOptimize(PuzzleState);
+    }
+}
+BENCHMARK(BM_PuzzleAdvance)->Arg(1)->Arg(16)->Arg(256);
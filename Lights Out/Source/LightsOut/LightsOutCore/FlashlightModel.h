@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// The flashlight's focus model, free of any engine types so it can be built and checked without the editor.
+namespace LightsOutCore
+{
+    inline float Lerp(float From, float To, float Alpha)
+    {
+        return From + (To - From) * Alpha;
+    }
+
+    inline float Clamp(float Value, float Min, float Max)
+    {
+        return Value < Min ? Min : (Value > Max ? Max : Value);
+    }
+
+    // The ends of each channel, the wide beam at 0% focus and the narrow one at 100%.
+    struct FlashlightLimits
+    {
+        float MinimumConsumptionRate;
+        float MaximumConsumptionRate;
+        float MinimumRadius;
+        float MaximumRadius;
+        float MinimumIntensity;
+        float MaximumIntensity;
+        float MinimumRange;
+        float MaximumRange;
+    };
+
+    // The flashlight's parameters at one point of the focus range.
+    struct FlashlightSample
+    {
+        float ConsumptionRate;
+        float Radius;
+        float Intensity;
+        float Range;
+    };
+
+    // Evaluates every channel at a focus percentage between 0 and 100. The radius shrinks as the
+    // focus goes up while everything else grows.
+    inline FlashlightSample LerpFlashlight(const FlashlightLimits &Limits, float Percentage)
+    {
+        const float Alpha = Percentage / 100.0f;
+
+        FlashlightSample Sample;
+        Sample.ConsumptionRate = Lerp(Limits.MinimumConsumptionRate, Limits.MaximumConsumptionRate, Alpha);
+        Sample.Radius = Lerp(Limits.MinimumRadius, Limits.MaximumRadius, 1.0f - Alpha);
+        Sample.Intensity = Lerp(Limits.MinimumIntensity, Limits.MaximumIntensity, Alpha);
+        Sample.Range = Lerp(Limits.MinimumRange, Limits.MaximumRange, Alpha);
+        return Sample;
+    }
+
+    // Moves the focus by Speed percent per second for DeltaTime seconds, staying within 0 and 100.
+    inline float StepFocus(float Percentage, float Speed, float DeltaTime)
+    {
+        return Clamp(Percentage + Speed * DeltaTime, 0.0f, 100.0f);
+    }
+
+    // An object inside the beam's cone, with what is needed to tell whether the beam is aimed at it.
+    struct BeamCandidate
+    {
+        // Cosine of the angle between the beam's axis and the direction to the object.
+        float Alignment;
+        float Coverage;
+        // Coverage the object needs to count as lit.
+        float Threshold;
+    };
+
+    // Returns the candidate lit enough that is closest to the beam's axis, or -1 if none is. The cone
+    // is wide enough to take in several objects next to each other, only the one aimed at is lit.
+    inline int PickBeamTarget(const BeamCandidate *Candidates, int Count)
+    {
+        int Best = -1;
+        for(int Index = 0; Index < Count; Index++)
+        {
+            const BeamCandidate &Candidate = Candidates[Index];
+            if(Candidate.Coverage >= Candidate.Threshold && (Best < 0 || Candidate.Alignment > Candidates[Best].Alignment))
+            {
+                Best = Index;
+            }
+        }
+        return Best;
+    }
+
+    // The focus range sampled at evenly spaced points, so changing the focus is a table lookup.
+    class FlashlightCurve
+    {
+        public:
+
+            void Build(const FlashlightLimits &Limits, int SampleCount)
+            {
+                if(SampleCount < 2) { SampleCount = 2; }
+
+                Samples.resize(SampleCount);
+                for(int Index = 0; Index < SampleCount; Index++)
+                {
+                    Samples[Index] = LerpFlashlight(Limits, 100.0f * Index / (SampleCount - 1));
+                }
+            }
+
+            bool IsBuilt() const { return Samples.size() >= 2; }
+            std::size_t GetAllocatedSize() const { return Samples.capacity() * sizeof(FlashlightSample); }
+
+            FlashlightSample Evaluate(float Percentage) const
+            {
+                const int Last = int(Samples.size()) - 1;
+                const float Position = Clamp(Percentage / 100.0f, 0.0f, 1.0f) * Last;
+                int Index = int(Position);
+                if(Index > Last - 1) { Index = Last - 1; }
+                const float Alpha = Position - Index;
+
+                const FlashlightSample &From = Samples[Index];
+                const FlashlightSample &To = Samples[Index + 1];
+
+                FlashlightSample Sample;
+                Sample.ConsumptionRate = Lerp(From.ConsumptionRate, To.ConsumptionRate, Alpha);
+                Sample.Radius = Lerp(From.Radius, To.Radius, Alpha);
+                Sample.Intensity = Lerp(From.Intensity, To.Intensity, Alpha);
+                Sample.Range = Lerp(From.Range, To.Range, Alpha);
+                return Sample;
+            }
+
+        private:
+
+            std::vector<FlashlightSample> Samples;
+    };
+}
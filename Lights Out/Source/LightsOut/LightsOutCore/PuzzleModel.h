@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Puzzle sequence logic, free of any engine types so it can be built and checked without the editor.
+namespace LightsOutCore
+{
+    // A transition packs the next state with flags saying whether the gem broke the sequence and
+    // whether the next state solves the puzzle.
+    enum PuzzleTransition
+    {
+        PuzzleStateMask = 0x3FFF,
+        PuzzleFailedFlag = 0x4000,
+        PuzzleCompleteFlag = 0x8000
+    };
+
+    // Result of lighting one gem in a single fixed sequence.
+    struct SequenceStep
+    {
+        int NextGoal;
+        bool Failed;
+        bool Complete;
+    };
+
+    // Advances a single fixed sequence: a matching gem moves to the next goal, anything else starts over.
+    inline SequenceStep AdvanceSequence(int CurrentGoal, bool Matches, int Length)
+    {
+        SequenceStep Step;
+        Step.NextGoal = Matches ? CurrentGoal + 1 : 0;
+        Step.Failed = !Matches;
+        Step.Complete = Matches && Step.NextGoal >= Length;
+        return Step;
+    }
+
+    // Any number of accepted gem sequences compiled into a flat table with one transition per state
+    // and gem ID. Patterns that start the same way share states and branch where they differ.
+    struct CompiledPuzzle
+    {
+        int NumGems = 0;
+        int MaxDepth = 0;
+        uint16_t MismatchTransition = PuzzleFailedFlag;
+        std::vector<uint16_t> Transitions;
+        std::vector<uint8_t> StateDepths;
+    };
+
+    // Returns the transition for lighting the gem while the puzzle is in the state.
+    inline uint16_t AdvancePuzzle(const uint16_t *Transitions, int NumGems, uint16_t MismatchTransition, int State, int GemId)
+    {
+        if(GemId < 0 || GemId >= NumGems)
+        {
+            return MismatchTransition;
+        }
+        return Transitions[State * NumGems + GemId];
+    }
+
+    // Builds the table. With RestartFromMismatch, a gem that breaks the sequence starts a new attempt
+    // if a pattern begins with it. Returns false if there are more states than a transition can address.
+    inline bool CompilePuzzle(const std::vector<std::vector<int>> &Patterns, bool RestartFromMismatch, CompiledPuzzle &Out)
+    {
+        // Lays the patterns out as a trie, state 0 being the start of an attempt.
+        std::vector<std::map<int, int>> Children(1);
+        std::vector<bool> Accepting(1, false);
+        Out.StateDepths.assign(1, 0);
+        Out.NumGems = 0;
+        Out.MaxDepth = 0;
+
+        for(const std::vector<int> &Pattern : Patterns)
+        {
+            if(Pattern.empty()) { continue; }
+
+            int State = 0;
+            for(int GemId : Pattern)
+            {
+                if(GemId < 0) { continue; }
+                if(GemId + 1 > Out.NumGems) { Out.NumGems = GemId + 1; }
+
+                std::map<int, int>::const_iterator Child = Children[State].find(GemId);
+                if(Child != Children[State].end())
+                {
+                    State = Child->second;
+                    continue;
+                }
+
+                const int NewState = int(Children.size());
+                const int Depth = Out.StateDepths[State] + 1;
+                Children.push_back(std::map<int, int>());
+                Accepting.push_back(false);
+                Out.StateDepths.push_back(uint8_t(Depth > 255 ? 255 : Depth));
+                Children[State][GemId] = NewState;
+                State = NewState;
+            }
+            Accepting[State] = true;
+            if(Out.StateDepths[State] > Out.MaxDepth) { Out.MaxDepth = Out.StateDepths[State]; }
+        }
+
+        const int NumStates = int(Children.size());
+        Out.MismatchTransition = PuzzleFailedFlag;
+        Out.Transitions.resize(std::size_t(NumStates) * Out.NumGems);
+        for(int State = 0; State < NumStates; State++)
+        {
+            for(int GemId = 0; GemId < Out.NumGems; GemId++)
+            {
+                std::map<int, int>::const_iterator Child = Children[State].find(GemId);
+                uint16_t Transition;
+                if(Child != Children[State].end())
+                {
+                    Transition = uint16_t((Accepting[Child->second] ? PuzzleCompleteFlag : 0) | Child->second);
+                }
+                else
+                {
+                    // A gem that breaks the sequence either restarts from nothing or, if allowed, from itself.
+                    std::map<int, int>::const_iterator Restart = Children[0].find(GemId);
+                    const int Next = RestartFromMismatch && Restart != Children[0].end() ? Restart->second : 0;
+                    Transition = uint16_t(PuzzleFailedFlag | (Accepting[Next] ? PuzzleCompleteFlag : 0) | Next);
+                }
+                Out.Transitions[std::size_t(State) * Out.NumGems + GemId] = Transition;
+            }
+        }
+        return NumStates <= PuzzleStateMask;
+    }
+}
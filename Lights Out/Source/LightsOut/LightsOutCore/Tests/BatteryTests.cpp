@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOutCore/Battery.h"
+
+#include <gtest/gtest.h>
+
+using namespace LightsOutCore;
+
+TEST(Battery, DrainsAtRate)
+{
+    EXPECT_FLOAT_EQ(DrainBattery(100.0f, 2.0f, 5.0f), 90.0f);
+}
+
+TEST(Battery, ZeroRateDoesNotDrain)
+{
+    EXPECT_FLOAT_EQ(DrainBattery(100.0f, 60.0f, 0.0f), 100.0f);
+}
+
+TEST(Battery, DepletesOnceDrainedPastZero)
+{
+    EXPECT_FALSE(IsBatteryDead(DrainBattery(10.0f, 1.0f, 5.0f)));
+    EXPECT_TRUE(IsBatteryDead(DrainBattery(10.0f, 2.0f, 5.0f)));
+    EXPECT_TRUE(IsBatteryDead(DrainBattery(10.0f, 3.0f, 5.0f)));
+}
+
+TEST(Battery, AddsBelowMax)
+{
+    EXPECT_FLOAT_EQ(AddBattery(100.0f, 50.0f, 300.0f), 150.0f);
+}
+
+TEST(Battery, AddClampsToMax)
+{
+    EXPECT_FLOAT_EQ(AddBattery(280.0f, 50.0f, 300.0f), 300.0f);
+    EXPECT_FLOAT_EQ(AddBattery(300.0f, 1.0f, 300.0f), 300.0f);
+}
+
+TEST(Battery, AddRevivesDeadBattery)
+{
+    const float Life = AddBattery(DrainBattery(1.0f, 1.0f, 5.0f), 10.0f, 300.0f);
+    EXPECT_FLOAT_EQ(Life, 6.0f);
+    EXPECT_FALSE(IsBatteryDead(Life));
+}
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOutCore/FlashlightModel.h"
+
+#include <gtest/gtest.h>
+
+using namespace LightsOutCore;
+
+namespace
+{
+    FlashlightLimits MakeLimits()
+    {
+        FlashlightLimits Limits;
+        Limits.MinimumConsumptionRate = 1.0f;
+        Limits.MaximumConsumptionRate = 5.0f;
+        Limits.MinimumRadius = 10.0f;
+        Limits.MaximumRadius = 50.0f;
+        Limits.MinimumIntensity = 1000.0f;
+        Limits.MaximumIntensity = 5000.0f;
+        Limits.MinimumRange = 500.0f;
+        Limits.MaximumRange = 2500.0f;
+        return Limits;
+    }
+
+    void ExpectSample(const FlashlightSample &Actual, const FlashlightSample &Expected)
+    {
+        EXPECT_NEAR(Actual.ConsumptionRate, Expected.ConsumptionRate, 1e-3f);
+        EXPECT_NEAR(Actual.Radius, Expected.Radius, 1e-3f);
+        EXPECT_NEAR(Actual.Intensity, Expected.Intensity, 1e-2f);
+        EXPECT_NEAR(Actual.Range, Expected.Range, 1e-2f);
+    }
+}
+
+TEST(FlashlightModel, LerpEndpoints)
+{
+    const FlashlightLimits Limits = MakeLimits();
+
+    const FlashlightSample Wide = LerpFlashlight(Limits, 0.0f);
+    EXPECT_FLOAT_EQ(Wide.ConsumptionRate, 1.0f);
+    EXPECT_FLOAT_EQ(Wide.Radius, 50.0f);
+    EXPECT_FLOAT_EQ(Wide.Intensity, 1000.0f);
+    EXPECT_FLOAT_EQ(Wide.Range, 500.0f);
+
+    const FlashlightSample Narrow = LerpFlashlight(Limits, 100.0f);
+    EXPECT_FLOAT_EQ(Narrow.ConsumptionRate, 5.0f);
+    EXPECT_FLOAT_EQ(Narrow.Radius, 10.0f);
+    EXPECT_FLOAT_EQ(Narrow.Intensity, 5000.0f);
+    EXPECT_FLOAT_EQ(Narrow.Range, 2500.0f);
+}
+
+TEST(FlashlightModel, StepFocusStaysInRange)
+{
+    EXPECT_FLOAT_EQ(StepFocus(50.0f, 20.0f, 0.5f), 60.0f);
+    EXPECT_FLOAT_EQ(StepFocus(95.0f, 20.0f, 1.0f), 100.0f);
+    EXPECT_FLOAT_EQ(StepFocus(5.0f, -20.0f, 1.0f), 0.0f);
+}
+
+TEST(FlashlightCurve, NotBuiltUntilBuild)
+{
+    FlashlightCurve Curve;
+    EXPECT_FALSE(Curve.IsBuilt());
+    Curve.Build(MakeLimits(), 1);
+    EXPECT_TRUE(Curve.IsBuilt());
+}
+
+TEST(FlashlightCurve, EndpointsMatchLimits)
+{
+    const FlashlightLimits Limits = MakeLimits();
+    FlashlightCurve Curve;
+    Curve.Build(Limits, 17);
+
+    ExpectSample(Curve.Evaluate(0.0f), LerpFlashlight(Limits, 0.0f));
+    ExpectSample(Curve.Evaluate(100.0f), LerpFlashlight(Limits, 100.0f));
+}
+
+TEST(FlashlightCurve, ClampsOutsideRange)
+{
+    const FlashlightLimits Limits = MakeLimits();
+    FlashlightCurve Curve;
+    Curve.Build(Limits, 17);
+
+    ExpectSample(Curve.Evaluate(-50.0f), LerpFlashlight(Limits, 0.0f));
+    ExpectSample(Curve.Evaluate(250.0f), LerpFlashlight(Limits, 100.0f));
+}
+
+TEST(FlashlightCurve, InterpolatesBetweenSamples)
+{
+    const FlashlightLimits Limits = MakeLimits();
+
+    // Every channel is linear, so even the coarsest curve lands on the exact value between samples.
+    for(int SampleCount : { 2, 5, 64 })
+    {
+        FlashlightCurve Curve;
+        Curve.Build(Limits, SampleCount);
+        for(float Percentage : { 12.5f, 33.0f, 50.0f, 77.7f, 99.0f })
+        {
+            SCOPED_TRACE(testing::Message() << SampleCount << " samples at " << Percentage << "%");
+            ExpectSample(Curve.Evaluate(Percentage), LerpFlashlight(Limits, Percentage));
+        }
+    }
+}
+
+TEST(BeamTarget, NoneLitEnough)
+{
+    const BeamCandidate Candidates[] = { { 0.99f, 0.2f, 0.5f }, { 0.9f, 0.4f, 0.5f } };
+    EXPECT_EQ(PickBeamTarget(Candidates, 2), -1);
+    EXPECT_EQ(PickBeamTarget(Candidates, 0), -1);
+}
+
+TEST(BeamTarget, AdjacentGemsLightOnlyTheAimedOne)
+{
+    // Two gems side by side, both fully inside the cone. The neighbour comes first, as it might in
+    // whatever order the flashlight keeps them, but the one on the beam's axis is picked.
+    const BeamCandidate Candidates[] = { { 0.96f, 1.0f, 0.5f }, { 0.999f, 0.8f, 0.5f } };
+    EXPECT_EQ(PickBeamTarget(Candidates, 2), 1);
+}
+
+TEST(BeamTarget, SkipsAlignedButOccluded)
+{
+    // The gem on the axis is mostly blocked, so the lit one beside it is picked instead.
+    const BeamCandidate Candidates[] = { { 0.999f, 0.1f, 0.5f }, { 0.96f, 0.9f, 0.5f } };
+    EXPECT_EQ(PickBeamTarget(Candidates, 2), 1);
+}
+
+TEST(BeamTarget, LitGemUsesLowerThreshold)
+{
+    // Already lit at 0.3 coverage with the lower threshold, so it stays the target.
+    const BeamCandidate Candidates[] = { { 0.999f, 0.3f, 0.25f }, { 0.9f, 0.2f, 0.5f } };
+    EXPECT_EQ(PickBeamTarget(Candidates, 2), 0);
+}
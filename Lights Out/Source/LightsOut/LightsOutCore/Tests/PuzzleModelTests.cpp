@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOutCore/PuzzleModel.h"
+
+#include <gtest/gtest.h>
+
+using namespace LightsOutCore;
+
+namespace
+{
+    // Lights each gem in turn from the start state and returns the last transition.
+    uint16_t Play(const CompiledPuzzle &Puzzle, const std::vector<int> &Gems)
+    {
+        int State = 0;
+        uint16_t Transition = 0;
+        for(int GemId : Gems)
+        {
+            Transition = AdvancePuzzle(Puzzle.Transitions.data(), Puzzle.NumGems, Puzzle.MismatchTransition, State, GemId);
+            State = Transition & PuzzleStateMask;
+        }
+        return Transition;
+    }
+
+    CompiledPuzzle Compile(const std::vector<std::vector<int>> &Patterns, bool RestartFromMismatch)
+    {
+        CompiledPuzzle Puzzle;
+        EXPECT_TRUE(CompilePuzzle(Patterns, RestartFromMismatch, Puzzle));
+        return Puzzle;
+    }
+}
+
+TEST(PuzzleSequence, AdvancesAndCompletes)
+{
+    SequenceStep Step = AdvanceSequence(0, true, 2);
+    EXPECT_EQ(Step.NextGoal, 1);
+    EXPECT_FALSE(Step.Failed);
+    EXPECT_FALSE(Step.Complete);
+
+    Step = AdvanceSequence(1, true, 2);
+    EXPECT_TRUE(Step.Complete);
+
+    Step = AdvanceSequence(1, false, 2);
+    EXPECT_EQ(Step.NextGoal, 0);
+    EXPECT_TRUE(Step.Failed);
+    EXPECT_FALSE(Step.Complete);
+}
+
+TEST(PuzzleTable, SharesPrefixes)
+{
+    const CompiledPuzzle Puzzle = Compile({ { 0, 1, 2 }, { 0, 1, 3 } }, false);
+    EXPECT_EQ(Puzzle.NumGems, 4);
+    EXPECT_EQ(Puzzle.MaxDepth, 3);
+    // Start, 0, 0-1, 0-1-2 and 0-1-3.
+    EXPECT_EQ(Puzzle.StateDepths.size(), 5u);
+    EXPECT_EQ(Puzzle.Transitions.size(), 5u * 4u);
+}
+
+TEST(PuzzleTable, MatchAdvancesWithoutFlags)
+{
+    const CompiledPuzzle Puzzle = Compile({ { 0, 1, 2 } }, false);
+
+    const uint16_t Transition = Play(Puzzle, { 0, 1 });
+    EXPECT_EQ(Transition & (PuzzleFailedFlag | PuzzleCompleteFlag), 0);
+    EXPECT_EQ(Puzzle.StateDepths[Transition & PuzzleStateMask], 2);
+}
+
+TEST(PuzzleTable, CompletesOnLastGem)
+{
+    const CompiledPuzzle Puzzle = Compile({ { 0, 1, 2 }, { 3 } }, false);
+
+    EXPECT_TRUE(Play(Puzzle, { 0, 1, 2 }) & PuzzleCompleteFlag);
+    EXPECT_TRUE(Play(Puzzle, { 3 }) & PuzzleCompleteFlag);
+    EXPECT_FALSE(Play(Puzzle, { 0, 1 }) & PuzzleCompleteFlag);
+}
+
+TEST(PuzzleTable, MismatchStartsOver)
+{
+    const CompiledPuzzle Puzzle = Compile({ { 0, 1, 2 } }, false);
+
+    const uint16_t Transition = Play(Puzzle, { 0, 1, 0 });
+    EXPECT_TRUE(Transition & PuzzleFailedFlag);
+    EXPECT_EQ(Transition & PuzzleStateMask, 0);
+}
+
+TEST(PuzzleTable, MismatchRestartsFromItself)
+{
+    const CompiledPuzzle Puzzle = Compile({ { 0, 1, 2 } }, true);
+
+    // The 0 that broke the sequence counts as the start of a new attempt.
+    const uint16_t Transition = Play(Puzzle, { 0, 1, 0 });
+    EXPECT_TRUE(Transition & PuzzleFailedFlag);
+    EXPECT_EQ(Puzzle.StateDepths[Transition & PuzzleStateMask], 1);
+    EXPECT_TRUE(Play(Puzzle, { 0, 1, 0, 1, 2 }) & PuzzleCompleteFlag);
+
+    // A gem no pattern starts with still goes back to the start.
+    EXPECT_EQ(Play(Puzzle, { 0, 2 }) & PuzzleStateMask, 0);
+}
+
+TEST(PuzzleTable, MismatchRestartCanComplete)
+{
+    const CompiledPuzzle Puzzle = Compile({ { 0, 1 }, { 2 } }, true);
+
+    const uint16_t Transition = Play(Puzzle, { 0, 2 });
+    EXPECT_TRUE(Transition & PuzzleFailedFlag);
+    EXPECT_TRUE(Transition & PuzzleCompleteFlag);
+}
+
+TEST(PuzzleTable, UnknownGemIsMismatch)
+{
+    const CompiledPuzzle Puzzle = Compile({ { 0, 1 } }, false);
+
+    EXPECT_EQ(AdvancePuzzle(Puzzle.Transitions.data(), Puzzle.NumGems, Puzzle.MismatchTransition, 1, 7), Puzzle.MismatchTransition);
+    EXPECT_EQ(AdvancePuzzle(Puzzle.Transitions.data(), Puzzle.NumGems, Puzzle.MismatchTransition, 1, -1), Puzzle.MismatchTransition);
+    EXPECT_TRUE(Puzzle.MismatchTransition & PuzzleFailedFlag);
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "LightsOutGameInstance.h"
+#include "LightsOutPerf.h"
+#include "LightsOutInputCapture.h"
+#include "MoviePlayer.h"
+#include "SlateBasics.h"
+#include "SThrobber.h"
+
+void ULightsOutGameInstance::Init()
+{
+    Super::Init();
+    
+    HasDrawnFrame = false;
+    FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &ULightsOutGameInstance::BeginLoadingScreen);
+    FCoreUObjectDelegates::PostLoadMap.AddUObject(this, &ULightsOutGameInstance::EndLoadingScreen);
+    
+    PreloadStartTime = FPlatformTime::Seconds();
+    Streamable.RequestAsyncLoad(PreloadManifest, FStreamableDelegate::CreateUObject(this, &ULightsOutGameInstance::OnPreloadComplete));
+    
+    // Every launch is a new game unless -Continue is given. Perf gate and input capture runs always
+    // start fresh and never write the save file, so the state they measure does not depend on it.
+    IsAutomatedRun = FLightsOutPerf::IsGateEnabled() || FLightsOutInputCapture::IsRequested();
+    if(!IsAutomatedRun && FParse::Param(FCommandLine::Get(), TEXT("Continue")) && Checkpoint.Load(FLightsOutCheckpoint::GetDefaultFilename()))
+    {
+        UE_LOG(LogLightsOut, Log, TEXT("Continuing from the checkpoint in %s"), *FLightsOutCheckpoint::GetDefaultFilename());
+    }
+}
+
+void ULightsOutGameInstance::Shutdown()
+{
+    FCoreUObjectDelegates::PreLoadMap.RemoveAll(this);
+    FCoreUObjectDelegates::PostLoadMap.RemoveAll(this);
+    
+    Super::Shutdown();
+}
+
+void ULightsOutGameInstance::RequestAsyncLoad(UObject *WorldContextObject, const TArray<FStringAssetReference> &Assets)
+{
+    ULightsOutGameInstance *GameInstance = Get(WorldContextObject);
+    if(GameInstance == nullptr) { return; }
+    
+    TArray<FStringAssetReference> Pending;
+    for(const FStringAssetReference &Asset : Assets)
+    {
+        if(Asset.IsValid() && Asset.ResolveObject() == nullptr)
+        {
+            Pending.Add(Asset);
+        }
+    }
+    if(Pending.Num() > 0)
+    {
+        GameInstance->Streamable.RequestAsyncLoad(Pending, FStreamableDelegate());
+    }
+}
+
+ULightsOutGameInstance *ULightsOutGameInstance::Get(UObject *WorldContextObject)
+{
+    UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, false);
+    return World ? Cast<ULightsOutGameInstance>(World->GetGameInstance()) : Cast<ULightsOutGameInstance>(WorldContextObject);
+}
+
+UObject *ULightsOutGameInstance::LoadOnDemand(UObject *WorldContextObject, const FStringAssetReference &Asset)
+{
+    UE_LOG(LogLightsOut, Warning, TEXT("%s was not preloaded and is being loaded on demand"), *Asset.ToString());
+    
+    ULightsOutGameInstance *GameInstance = Get(WorldContextObject);
+    return GameInstance ? GameInstance->Streamable.SynchronousLoad(Asset) : Asset.TryLoad();
+}
+
+void ULightsOutGameInstance::SaveCheckpoint(UObject *WorldContextObject)
+{
+    ULightsOutGameInstance *GameInstance = Get(WorldContextObject);
+    UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, false);
+    if(GameInstance == nullptr || World == nullptr) { return; }
+    
+    GameInstance->Checkpoint.Capture(World);
+    if(!GameInstance->IsAutomatedRun)
+    {
+        GameInstance->Checkpoint.SaveAsync(FLightsOutCheckpoint::GetDefaultFilename());
+    }
+}
+
+bool ULightsOutGameInstance::RestoreCheckpoint(UObject *WorldContextObject)
+{
+    ULightsOutGameInstance *GameInstance = Get(WorldContextObject);
+    UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, false);
+    return GameInstance && World && GameInstance->Checkpoint.Restore(World);
+}
+
+const FLightsOutCheckpoint *ULightsOutGameInstance::FindCheckpoint(UObject *WorldContextObject)
+{
+    ULightsOutGameInstance *GameInstance = Get(WorldContextObject);
+    return GameInstance && GameInstance->Checkpoint.IsValid() ? &GameInstance->Checkpoint : nullptr;
+}
+
+void ULightsOutGameInstance::BeginLoadingScreen()
+{
+    if(IsRunningDedicatedServer()) { return; }
+    
+    FLoadingScreenAttributes LoadingScreen;
+    LoadingScreen.bAutoCompleteWhenLoadingCompletes = true;
+    LoadingScreen.WidgetLoadingScreen = CreateLoadingScreenWidget();
+    GetMoviePlayer()->SetupLoadingScreen(LoadingScreen);
+}
+
+// Black screen with the title and a throbber, drawn by the movie player's own thread while the map loads.
+TSharedRef<SWidget> ULightsOutGameInstance::CreateLoadingScreenWidget()
+{
+    return SNew(SBorder)
+        .BorderImage(FCoreStyle::Get().GetBrush("BlackBrush"))
+        .HAlign(HAlign_Center)
+        .VAlign(VAlign_Center)
+        [
+            SNew(SVerticalBox)
+            + SVerticalBox::Slot()
+            .AutoHeight()
+            .HAlign(HAlign_Center)
+            .Padding(0.0f, 0.0f, 0.0f, 24.0f)
+            [
+                SNew(STextBlock)
+                .Text(NSLOCTEXT("LightsOut", "LoadingTitle", "LIGHTS OUT"))
+                .Font(FSlateFontInfo(FPaths::EngineContentDir() / TEXT("Slate/Fonts/Roboto-Light.ttf"), 48))
+                .ColorAndOpacity(FLinearColor::White)
+            ]
+            + SVerticalBox::Slot()
+            .AutoHeight()
+            .HAlign(HAlign_Center)
+            [
+                SNew(SThrobber)
+            ]
+        ];
+}
+
+void ULightsOutGameInstance::EndLoadingScreen()
+{
+    UE_LOG(LogLightsOut, Log, TEXT("Map loaded %.2f seconds after startup"), FPlatformTime::Seconds() - GStartTime);
+}
+
+void ULightsOutGameInstance::OnPreloadComplete()
+{
+    UE_LOG(LogLightsOut, Log, TEXT("Preloaded %d assets in %.2f seconds"), PreloadManifest.Num(), FPlatformTime::Seconds() - PreloadStartTime);
+}
+
+void ULightsOutGameInstance::NotifyFrameDrawn()
+{
+    if(HasDrawnFrame) { return; }
+    
+    HasDrawnFrame = true;
+    UE_LOG(LogLightsOut, Display, TEXT("Time to first frame: %.2f seconds"), FPlatformTime::Seconds() - GStartTime);
+}
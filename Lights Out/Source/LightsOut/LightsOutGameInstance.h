@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "LightsOutCheckpoint.h"
+#include "LightsOutGameInstance.generated.h"
+
+class SWidget;
+
+/**
+ * Owns the streamable manager everything in the game loads its assets through. The assets in the
+ * preload manifest are requested as soon as the game starts, and maps load behind a loading screen,
+ * so the first frame does not wait on content that is referenced softly.
+ */
+UCLASS(config = Game)
+class LIGHTSOUT_API ULightsOutGameInstance : public UGameInstance
+{
+	GENERATED_BODY()
+	
+    public:
+    
+        virtual void Init() override;
+        virtual void Shutdown() override;
+    
+        FStreamableManager &GetStreamable() { return Streamable; }
+    
+        // Starts loading the assets in the background. Null references are skipped.
+        static void RequestAsyncLoad(UObject *WorldContextObject, const TArray<FStringAssetReference> &Assets);
+    
+        // Returns the asset, loading it on the spot if nothing requested it ahead of time.
+        template<typename T>
+        static T *Resolve(UObject *WorldContextObject, const TAssetPtr<T> &Asset)
+        {
+            if(T *Loaded = Asset.Get()) { return Loaded; }
+            return Asset.IsNull() ? nullptr : Cast<T>(LoadOnDemand(WorldContextObject, Asset.ToStringReference()));
+        }
+    
+        template<typename T>
+        static UClass *Resolve(UObject *WorldContextObject, const TAssetSubclassOf<T> &Class)
+        {
+            if(UClass *Loaded = Class.Get()) { return Loaded; }
+            return Class.IsNull() ? nullptr : Cast<UClass>(LoadOnDemand(WorldContextObject, Class.ToStringReference()));
+        }
+    
+        // Moves a hard reference loaded from an asset saved before the property became soft into its
+        // replacement. The old property is deprecated, so re-saving the asset drops it for good.
+        template<typename T>
+        static void MigrateReference(T *&Legacy, TAssetPtr<T> &Asset)
+        {
+            if(Legacy && Asset.IsNull()) { Asset = Legacy; }
+            Legacy = nullptr;
+        }
+    
+        template<typename T>
+        static void MigrateReference(TSubclassOf<T> &Legacy, TAssetSubclassOf<T> &Asset)
+        {
+            if(*Legacy && Asset.IsNull()) { Asset = *Legacy; }
+            Legacy = nullptr;
+        }
+    
+        // Records the world as the checkpoint and writes it to disk in the background. Automated runs
+        // keep it in memory only.
+        static void SaveCheckpoint(UObject *WorldContextObject);
+    
+        // Puts the world back to the last checkpoint. Returns false if there is none yet.
+        static bool RestoreCheckpoint(UObject *WorldContextObject);
+    
+        // The last checkpoint, from this session or from an earlier one when started with -Continue, or
+        // null if there is none.
+        static const FLightsOutCheckpoint *FindCheckpoint(UObject *WorldContextObject);
+    
+        // Called by the HUD every frame it draws, the first call logs how long the game took to show something.
+        void NotifyFrameDrawn();
+    
+    protected:
+    
+        void BeginLoadingScreen();
+        static TSharedRef<SWidget> CreateLoadingScreenWidget();
+        void EndLoadingScreen();
+        void OnPreloadComplete();
+    
+        static ULightsOutGameInstance *Get(UObject *WorldContextObject);
+        static UObject *LoadOnDemand(UObject *WorldContextObject, const FStringAssetReference &Asset);
+    
+    protected:
+    
+        //Assets loaded in the background as soon as the game starts
+        UPROPERTY(config)
+        TArray<FStringAssetReference> PreloadManifest;
+    
+    private:
+    
+        FStreamableManager Streamable;
+        FLightsOutCheckpoint Checkpoint;
+        double PreloadStartTime;
+        bool HasDrawnFrame;
+        // Started for the perf gate or to record or replay input.
+        bool IsAutomatedRun = false;
+};
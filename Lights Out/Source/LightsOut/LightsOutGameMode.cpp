@@ -4,14 +4,29 @@
 #include "LightsOutGameMode.h"
 #include "LightsOutHUD.h"
 #include "LightsOutCharacter.h"
+#include "LightsOutGameInstance.h"
 
 ALightsOutGameMode::ALightsOutGameMode()
 	: Super()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnClassFinder(TEXT("/Game/FirstPersonCPP/Blueprints/FirstPersonCharacter"));
-	DefaultPawnClass = PlayerPawnClassFinder.Class;
+	// the Blueprinted character is set in config as PlayerPawnClass and resolved when a player spawns
 
 	// use our custom HUD class
 	HUDClass = ALightsOutHUD::StaticClass();
 }
+
+void ALightsOutGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	// Every actor has begun play and the players have spawned by now, so the rooms, their gems and the
+	// players can all be set at once. There is only a checkpoint here when the game was started with
+	// -Continue or one was taken earlier in the session
+	ULightsOutGameInstance::RestoreCheckpoint(this);
+}
+
+UClass* ALightsOutGameMode::GetDefaultPawnClassForController_Implementation(AController* InController)
+{
+	UClass* PawnClass = ULightsOutGameInstance::Resolve(this, PlayerPawnClass);
+	return PawnClass != NULL ? PawnClass : Super::GetDefaultPawnClassForController_Implementation(InController);
+}
@@ -3,13 +3,23 @@
 #include "GameFramework/GameMode.h"
 #include "LightsOutGameMode.generated.h"
 
-UCLASS(minimalapi)
+UCLASS(minimalapi, config=Game)
 class ALightsOutGameMode : public AGameMode
 {
 	GENERATED_BODY()
 
 public:
 	ALightsOutGameMode();
+
+	virtual UClass* GetDefaultPawnClassForController_Implementation(AController* InController) override;
+
+	/** Starts the match, then continues from the checkpoint of an earlier session if there is one */
+	virtual void StartPlay() override;
+
+protected:
+	/** Pawn spawned for players, referenced softly so the game mode's defaults do not load it. Set in DefaultGame.ini and listed in the preload manifest */
+	UPROPERTY(config, EditDefaultsOnly, Category=Classes)
+	TAssetSubclassOf<APawn> PlayerPawnClass;
 };
 
 
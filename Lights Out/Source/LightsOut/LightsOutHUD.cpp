@@ -2,35 +2,94 @@
 
 #include "LightsOut.h"
 #include "LightsOutHUD.h"
-#include "Engine/Canvas.h"
-#include "TextureResource.h"
-#include "CanvasItem.h"
+#include "LightsOutGameInstance.h"
+#include "LightsOutHUDWidget.h"
+#include "LightsOutCharacter.h"
+#include "Flashlight.h"
 
 ALightsOutHUD::ALightsOutHUD()
 {
 	// Set the crosshair texture
-	static ConstructorHelpers::FObjectFinder<UTexture2D> CrosshiarTexObj(TEXT("/Game/FirstPerson/Textures/FirstPersonCrosshair"));
-	CrosshairTex = CrosshiarTexObj.Object;
+	CrosshairTex = TAssetPtr<UTexture2D>(FStringAssetReference(TEXT("/Game/FirstPerson/Textures/FirstPersonCrosshair.FirstPersonCrosshair")));
 }
 
 
+void ALightsOutHUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Each local player's widget goes in their own part of the viewport, so splitscreen HUDs do not overlap
+	ULocalPlayer* LocalPlayer = GetOwningPlayerController() != NULL ? GetOwningPlayerController()->GetLocalPlayer() : NULL;
+	if (GEngine != NULL && GEngine->GameViewport != NULL && LocalPlayer != NULL)
+	{
+		SAssignNew(HUDWidget, SLightsOutHUDWidget)
+			.Crosshair(ULightsOutGameInstance::Resolve(this, CrosshairTex))
+			.ServerTime(TAttribute<float>::FGetter::CreateUObject(this, &ALightsOutHUD::GetServerTime));
+		GEngine->GameViewport->AddViewportWidgetForPlayer(LocalPlayer, HUDWidget.ToSharedRef(), 0);
+		WidgetPlayer = LocalPlayer;
+	}
+}
+
+void ALightsOutHUD::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (BoundFlashlight.IsValid())
+	{
+		BoundFlashlight->OnBatteryChanged.Remove(BatteryChangedHandle);
+	}
+	if (HUDWidget.IsValid() && WidgetPlayer.IsValid() && GEngine != NULL && GEngine->GameViewport != NULL)
+	{
+		GEngine->GameViewport->RemoveViewportWidgetForPlayer(WidgetPlayer.Get(), HUDWidget.ToSharedRef());
+	}
+	HUDWidget.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ALightsOutHUD::DrawHUD()
 {
 	Super::DrawHUD();
 
-	// Draw very simple crosshair
+	ULightsOutGameInstance* GameInstance = Cast<ULightsOutGameInstance>(GetWorld()->GetGameInstance());
+	if (GameInstance != NULL)
+	{
+		GameInstance->NotifyFrameDrawn();
+	}
 
-	// find center of the Canvas
-	const FVector2D Center(Canvas->ClipX * 0.5f, Canvas->ClipY * 0.5f);
+	// The widget draws itself, the HUD only has to hook it up to the flashlight once it has replicated
+	BindFlashlight();
+}
 
-	// offset by half the texture's dimensions so that the center of the texture aligns with the center of the Canvas
-	const FVector2D CrosshairDrawPosition( (Center.X - (CrosshairTex->GetSurfaceWidth() * 0.5)),
-										   (Center.Y - (CrosshairTex->GetSurfaceHeight() * 0.5f)) );
+void ALightsOutHUD::BindFlashlight()
+{
+	ALightsOutCharacter* Character = Cast<ALightsOutCharacter>(GetOwningPawn());
+	AFlashlight* Flashlight = Character != NULL ? Character->GetFlashlight() : NULL;
+	if (Flashlight == BoundFlashlight.Get() || !HUDWidget.IsValid())
+	{
+		return;
+	}
 
-	// draw the crosshair
-//	FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTex->Resource, FLinearColor::White);
-//	TileItem.BlendMode = SE_BLEND_Translucent;
-//    Canvas->DrawItem( TileItem );
-//    DrawText("GameOver", FColor::Red, Center.X, Center.Y);
+	if (BoundFlashlight.IsValid())
+	{
+		BoundFlashlight->OnBatteryChanged.Remove(BatteryChangedHandle);
+	}
+	BoundFlashlight = Flashlight;
+	if (Flashlight != NULL)
+	{
+		BatteryChangedHandle = Flashlight->OnBatteryChanged.AddUObject(this, &ALightsOutHUD::OnBatteryChanged);
+		OnBatteryChanged(Flashlight->GetServerTime(), Flashlight->GetBatteryTime(), Flashlight->GetBatteryDrainRate());
+	}
 }
 
+void ALightsOutHUD::OnBatteryChanged(float AnchorTime, float Life, float DrainRate)
+{
+	if (HUDWidget.IsValid() && BoundFlashlight.IsValid())
+	{
+		HUDWidget->SetBattery(AnchorTime, Life, DrainRate, BoundFlashlight->GetMaxBatteryTime());
+	}
+}
+
+float ALightsOutHUD::GetServerTime() const
+{
+	const AGameState* GameState = GetWorld()->GameState;
+	return GameState != NULL ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
@@ -3,6 +3,8 @@
 #include "GameFramework/HUD.h"
 #include "LightsOutHUD.generated.h"
 
+class SLightsOutHUDWidget;
+
 UCLASS()
 class ALightsOutHUD : public AHUD
 {
@@ -11,12 +13,28 @@ class ALightsOutHUD : public AHUD
 public:
 	ALightsOutHUD();
 
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** Primary draw call for the HUD */
 	virtual void DrawHUD() override;
 //    void SetVisible(bool vis){ this->
 private:
-	/** Crosshair asset pointer */
-	class UTexture2D* CrosshairTex;
+	/** Connects the battery bar to the player's flashlight once it exists */
+	void BindFlashlight();
+	void OnBatteryChanged(float AnchorTime, float Life, float DrainRate);
+	float GetServerTime() const;
+
+	/** Crosshair asset, referenced softly and listed in the preload manifest */
+	TAssetPtr<class UTexture2D> CrosshairTex;
+
+	/** Crosshair and battery bar, painted by Slate and only redrawn when they change */
+	TSharedPtr<SLightsOutHUDWidget> HUDWidget;
+
+	/** Player whose part of the viewport the widget was added to */
+	TWeakObjectPtr<class ULocalPlayer> WidgetPlayer;
 
+	TWeakObjectPtr<class AFlashlight> BoundFlashlight;
+	FDelegateHandle BatteryChangedHandle;
 };
 
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "LightsOutHUDWidget.h"
+#include "SInvalidationPanel.h"
+#include "SProgressBar.h"
+#include "LightsOutCore/Battery.h"
+
+void SLightsOutHUDWidget::Construct(const FArguments &InArgs)
+{
+    BarSize = InArgs._BarSize;
+    ServerTime = InArgs._ServerTime;
+    AnchorTime = 0;
+    AnchorLife = 0;
+    DrainRate = 0;
+    MaxLife = 1;
+    DisplayedPixels = 0;
+    
+    if(InArgs._Crosshair)
+    {
+        CrosshairBrush.SetResourceObject(InArgs._Crosshair);
+        CrosshairBrush.ImageSize = FVector2D(InArgs._Crosshair->GetSurfaceWidth(), InArgs._Crosshair->GetSurfaceHeight());
+    }
+    else
+    {
+        CrosshairBrush.DrawAs = ESlateBrushDrawType::NoDrawType;
+    }
+    
+    ChildSlot
+    [
+        SAssignNew(InvalidationPanel, SInvalidationPanel)
+        [
+            SNew(SOverlay)
+            + SOverlay::Slot()
+            .HAlign(HAlign_Center)
+            .VAlign(VAlign_Center)
+            [
+                SNew(SImage)
+                .Image(&CrosshairBrush)
+            ]
+            + SOverlay::Slot()
+            .HAlign(HAlign_Left)
+            .VAlign(VAlign_Bottom)
+            .Padding(FMargin(24.0f))
+            [
+                SNew(SBox)
+                .WidthOverride(BarSize.X)
+                .HeightOverride(BarSize.Y)
+                [
+                    SAssignNew(BatteryBar, SProgressBar)
+                    .Percent(0.0f)
+                ]
+            ]
+        ]
+    ];
+}
+
+void SLightsOutHUDWidget::SetBattery(float InAnchorTime, float Life, float InDrainRate, float InMaxLife)
+{
+    AnchorTime = InAnchorTime;
+    AnchorLife = Life;
+    DrainRate = InDrainRate;
+    MaxLife = FMath::Max(InMaxLife, KINDA_SMALL_NUMBER);
+    UpdateBar();
+    
+    if(BatteryTimer.IsValid())
+    {
+        UnRegisterActiveTimer(BatteryTimer.ToSharedRef());
+        BatteryTimer.Reset();
+    }
+    
+    // The bar only has to be looked at again once it has drained by a pixel. The timer runs on real time,
+    // so a paused or dilated game just wakes it without the bar moving.
+    if(DrainRate > 0 && AnchorLife > 0)
+    {
+        const float SecondsPerPixel = MaxLife / (BarSize.X * DrainRate);
+        BatteryTimer = RegisterActiveTimer(SecondsPerPixel, FWidgetActiveTimerDelegate::CreateSP(this, &SLightsOutHUDWidget::OnBatteryTimer));
+    }
+}
+
+EActiveTimerReturnType SLightsOutHUDWidget::OnBatteryTimer(double CurrentTime, float DeltaTime)
+{
+    UpdateBar();
+    if(GetBatteryFraction() <= 0)
+    {
+        BatteryTimer.Reset();
+        return EActiveTimerReturnType::Stop;
+    }
+    return EActiveTimerReturnType::Continue;
+}
+
+void SLightsOutHUDWidget::UpdateBar()
+{
+    const float Fraction = GetBatteryFraction();
+    const int32 Pixels = FMath::RoundToInt(Fraction * BarSize.X);
+    if(Pixels == DisplayedPixels)
+    {
+        return;
+    }
+    
+    DisplayedPixels = Pixels;
+    BatteryBar->SetPercent(Fraction);
+    InvalidationPanel->InvalidateCache();
+}
+
+float SLightsOutHUDWidget::GetBatteryFraction() const
+{
+    const float Elapsed = FMath::Max(ServerTime.Get() - AnchorTime, 0.0f);
+    return FMath::Clamp(LightsOutCore::DrainBattery(AnchorLife, Elapsed, DrainRate) / MaxLife, 0.0f, 1.0f);
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "SlateBasics.h"
+
+/**
+ * Crosshair and battery bar drawn inside an invalidation panel, so the HUD is painted from a cached
+ * draw list and only redrawn when something visibly changes. The battery is extrapolated from the
+ * life and drain rate the flashlight reports, and a timer wakes the widget when the bar is due to
+ * lose its next pixel.
+ */
+class LIGHTSOUT_API SLightsOutHUDWidget : public SCompoundWidget
+{
+    public:
+
+        SLATE_BEGIN_ARGS(SLightsOutHUDWidget)
+            : _Crosshair(nullptr)
+            , _BarSize(FVector2D(300.0f, 16.0f))
+        {}
+            SLATE_ARGUMENT(UTexture2D*, Crosshair)
+            SLATE_ARGUMENT(FVector2D, BarSize)
+            // Current world time on the server, the clock the battery anchor is measured on.
+            SLATE_ATTRIBUTE(float, ServerTime)
+        SLATE_END_ARGS()
+
+        void Construct(const FArguments &InArgs);
+
+        // Restarts the extrapolation from the battery life at a server time and its drain rate, all in seconds.
+        void SetBattery(float AnchorTime, float Life, float DrainRate, float MaxLife);
+
+    private:
+
+        EActiveTimerReturnType OnBatteryTimer(double CurrentTime, float DeltaTime);
+        // Moves the bar to the battery's current width, repainting only if that is a different pixel.
+        void UpdateBar();
+        float GetBatteryFraction() const;
+
+    private:
+
+        TSharedPtr<class SInvalidationPanel> InvalidationPanel;
+        TSharedPtr<class SProgressBar> BatteryBar;
+        TSharedPtr<FActiveTimerHandle> BatteryTimer;
+        FSlateBrush CrosshairBrush;
+        FVector2D BarSize;
+
+        TAttribute<float> ServerTime;
+        float AnchorTime;
+        float AnchorLife;
+        float DrainRate;
+        float MaxLife;
+        int32 DisplayedPixels;
+};
@@ -0,0 +1,308 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "LightsOutInputCapture.h"
+#include "LightsOutPerf.h"
+#include "Components/InputComponent.h"
+#include "GameFramework/PlayerInput.h"
+
+static TAutoConsoleVariable<int32> CVarInputCaptureFrameRate(
+    TEXT("LightsOut.Input.FrameRate"),
+    60,
+    TEXT("Fixed frame rate new input recordings are made at. Replays use the rate stored in the recording."));
+
+static TAutoConsoleVariable<int32> CVarInputCaptureRingSize(
+    TEXT("LightsOut.Input.RingBufferKB"),
+    64,
+    TEXT("Size of the buffer input recordings are written into before they go to the file."));
+
+// The streams in a recording, in the order of their bits in each frame's header byte.
+static const FName CaptureAxes[] = { TEXT("MoveForward"), TEXT("MoveRight"), TEXT("Turn"), TEXT("LookUp"), TEXT("FocusFlashlight") };
+static const FName CaptureActions[] = { TEXT("Run"), TEXT("FlashlightToggle") };
+
+static const uint32 CaptureMagic = 0x52494F4C;
+static const uint32 CaptureVersion = 1;
+
+// Axis values are stored in steps of 1/4096, mouse axes go well past 1 so they are not clamped.
+static const float AxisScale = 4096.0f;
+
+bool FLightsOutInputCapture::IsRequested()
+{
+    FString Filename;
+    return FParse::Value(FCommandLine::Get(), TEXT("RecordInput="), Filename) || FParse::Value(FCommandLine::Get(), TEXT("ReplayInput="), Filename);
+}
+
+void FLightsOutInputCapture::Bind(APawn *Pawn, UInputComponent *InputComponent)
+{
+    UWorld *World = Pawn->GetWorld();
+    FLightsOutInputCapture *Capture = TLightsOutPerWorld<FLightsOutInputCapture>::Find(World);
+    if(Capture == nullptr)
+    {
+        FString Filename;
+        EMode Mode;
+        if(FParse::Value(FCommandLine::Get(), TEXT("RecordInput="), Filename))
+        {
+            Mode = EMode::Record;
+        }
+        else if(FParse::Value(FCommandLine::Get(), TEXT("ReplayInput="), Filename))
+        {
+            Mode = EMode::Replay;
+        }
+        else
+        {
+            return;
+        }
+
+        if(FPaths::IsRelative(Filename))
+        {
+            Filename = FPaths::ProfilingDir() / Filename;
+        }
+        Capture = new FLightsOutInputCapture(Mode, Filename);
+        if(!Capture->Open())
+        {
+            delete Capture;
+            return;
+        }
+        TLightsOutPerWorld<FLightsOutInputCapture>::Add(World, Capture);
+    }
+
+    Capture->Pawn = Pawn;
+    Capture->InputComponent = InputComponent;
+
+    // Only the recording moves the pawn, the real input would add to it.
+    if(Capture->Mode == EMode::Replay)
+    {
+        Pawn->DisableInput(Cast<APlayerController>(Pawn->Controller));
+    }
+}
+
+FLightsOutInputCapture::FLightsOutInputCapture(EMode InMode, const FString &InFilename)
+    : Mode(InMode)
+    , Filename(InFilename)
+    , FrameCount(0)
+    , HasFinished(false)
+    , ActionBits(0)
+    , File(nullptr)
+    , Written(0)
+    , Flushed(0)
+    , Cursor(0)
+{
+    FMemory::Memzero(AxisValues);
+}
+
+FLightsOutInputCapture::~FLightsOutInputCapture()
+{
+    if(File)
+    {
+        Flush();
+        File->Close();
+        delete File;
+        UE_LOG(LogLightsOut, Log, TEXT("Recorded %d frames of input to %s (%llu bytes)"), FrameCount, *Filename, Written);
+    }
+}
+
+bool FLightsOutInputCapture::Open()
+{
+    uint32 FrameRate = 0;
+    if(Mode == EMode::Record)
+    {
+        File = IFileManager::Get().CreateFileWriter(*Filename);
+        if(File == nullptr)
+        {
+            UE_LOG(LogLightsOut, Error, TEXT("Could not open %s to record input"), *Filename);
+            return false;
+        }
+        Ring.SetNumUninitialized(FMath::Max(CVarInputCaptureRingSize.GetValueOnGameThread(), 1) * 1024);
+
+        FrameRate = FMath::Max(CVarInputCaptureFrameRate.GetValueOnGameThread(), 1);
+        WriteVarint(CaptureMagic);
+        WriteVarint(CaptureVersion);
+        WriteVarint(FrameRate);
+    }
+    else
+    {
+        uint32 Magic = 0;
+        uint32 Version = 0;
+        if(!FFileHelper::LoadFileToArray(Data, *Filename) || !ReadVarint(Magic) || !ReadVarint(Version) || !ReadVarint(FrameRate) ||
+           Magic != CaptureMagic || Version != CaptureVersion || FrameRate == 0)
+        {
+            UE_LOG(LogLightsOut, Error, TEXT("%s is not an input recording this build can replay"), *Filename);
+            return false;
+        }
+        FLightsOutPerf::StartCapture();
+    }
+
+    FApp::SetUseFixedTimeStep(true);
+    FApp::SetFixedDeltaTime(1.0 / FrameRate);
+    UE_LOG(LogLightsOut, Log, TEXT("%s input %s at a fixed %u frames per second"), Mode == EMode::Record ? TEXT("Recording") : TEXT("Replaying"), *Filename, FrameRate);
+    return true;
+}
+
+void FLightsOutInputCapture::Tick(float DeltaTime)
+{
+    if(Mode == EMode::Record)
+    {
+        RecordFrame();
+    }
+    else
+    {
+        FLightsOutPerf::Record(TEXT("GameThread"), FPlatformTime::ToMilliseconds(GGameThreadTime));
+        ReplayFrame();
+    }
+}
+
+// Ticking after the world, so this sees the values the bindings were given this frame.
+void FLightsOutInputCapture::RecordFrame()
+{
+    APlayerController *PlayerController = Cast<APlayerController>(Pawn.IsValid() ? Pawn->Controller : nullptr);
+    if(PlayerController == nullptr || PlayerController->PlayerInput == nullptr) { return; }
+
+    uint8 Header = 0;
+    int32 Deltas[NumAxes];
+    for(int32 Axis = 0; Axis < NumAxes; Axis++)
+    {
+        const int32 Value = FMath::RoundToInt(InputComponent->GetAxisValue(CaptureAxes[Axis]) * AxisScale);
+        Deltas[Axis] = Value - AxisValues[Axis];
+        AxisValues[Axis] = Value;
+        Header |= Deltas[Axis] != 0 ? 1 << Axis : 0;
+    }
+
+    ActionBits = 0;
+    for(int32 Action = 0; Action < NumActions; Action++)
+    {
+        for(const FInputActionKeyMapping &Mapping : PlayerController->PlayerInput->GetKeysForAction(CaptureActions[Action]))
+        {
+            if(PlayerController->IsInputKeyDown(Mapping.Key))
+            {
+                ActionBits |= 1 << Action;
+                break;
+            }
+        }
+    }
+    Header |= ActionBits << NumAxes;
+
+    // A frame where nothing changed costs the header byte only.
+    WriteByte(Header);
+    for(int32 Axis = 0; Axis < NumAxes; Axis++)
+    {
+        if(Deltas[Axis] != 0)
+        {
+            WriteVarint((uint32(Deltas[Axis]) << 1) ^ uint32(Deltas[Axis] >> 31));
+        }
+    }
+
+    FrameCount++;
+
+    if(Written - Flushed >= uint64(Ring.Num() / 2))
+    {
+        Flush();
+    }
+}
+
+// Calls the bindings the same way the player input would have for the recorded frame.
+void FLightsOutInputCapture::ReplayFrame()
+{
+    if(Cursor >= Data.Num())
+    {
+        Finish();
+        return;
+    }
+
+    const uint8 Header = Data[Cursor++];
+    for(int32 Axis = 0; Axis < NumAxes; Axis++)
+    {
+        uint32 Encoded = 0;
+        if((Header & (1 << Axis)) && ReadVarint(Encoded))
+        {
+            AxisValues[Axis] += int32(Encoded >> 1) ^ -int32(Encoded & 1);
+        }
+        for(FInputAxisBinding &Binding : InputComponent->AxisBindings)
+        {
+            if(Binding.AxisName == CaptureAxes[Axis])
+            {
+                Binding.AxisValue = AxisValues[Axis] / AxisScale;
+                Binding.AxisDelegate.Execute(Binding.AxisValue);
+            }
+        }
+    }
+
+    const uint8 NewActionBits = Header >> NumAxes;
+    for(int32 Action = 0; Action < NumActions; Action++)
+    {
+        const bool IsHeld = (NewActionBits & (1 << Action)) != 0;
+        if(IsHeld == ((ActionBits & (1 << Action)) != 0)) { continue; }
+
+        const EInputEvent KeyEvent = IsHeld ? IE_Pressed : IE_Released;
+        for(int32 Index = 0; Index < InputComponent->GetNumActionBindings(); Index++)
+        {
+            FInputActionBinding &Binding = InputComponent->GetActionBinding(Index);
+            if(Binding.ActionName == CaptureActions[Action] && Binding.KeyEvent == KeyEvent)
+            {
+                Binding.ActionDelegate.Execute(EKeys::Invalid);
+            }
+        }
+    }
+    ActionBits = NewActionBits;
+    FrameCount++;
+}
+
+void FLightsOutInputCapture::Finish()
+{
+    HasFinished = true;
+    UE_LOG(LogLightsOut, Display, TEXT("Replayed %d frames of input from %s"), FrameCount, *Filename);
+
+    FLightsOutPerf::StopCapture();
+    FPlatformMisc::RequestExit(false);
+}
+
+void FLightsOutInputCapture::WriteByte(uint8 Value)
+{
+    if(Written - Flushed == uint64(Ring.Num()))
+    {
+        Flush();
+    }
+    Ring[Written % Ring.Num()] = Value;
+    Written++;
+}
+
+void FLightsOutInputCapture::WriteVarint(uint32 Value)
+{
+    while(Value >= 0x80)
+    {
+        WriteByte(uint8(Value) | 0x80);
+        Value >>= 7;
+    }
+    WriteByte(uint8(Value));
+}
+
+// Writes everything in the ring since the last flush, which may wrap around its end.
+void FLightsOutInputCapture::Flush()
+{
+    while(Flushed < Written)
+    {
+        const int32 Start = int32(Flushed % Ring.Num());
+        const int32 Count = int32(FMath::Min<uint64>(Written - Flushed, Ring.Num() - Start));
+        File->Serialize(Ring.GetData() + Start, Count);
+        Flushed += Count;
+    }
+}
+
+bool FLightsOutInputCapture::ReadVarint(uint32 &OutValue)
+{
+    OutValue = 0;
+    for(int32 Shift = 0; Shift < 35 && Cursor < Data.Num(); Shift += 7)
+    {
+        const uint8 Byte = Data[Cursor++];
+        OutValue |= uint32(Byte & 0x7F) << Shift;
+        if((Byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+TStatId FLightsOutInputCapture::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(FLightsOutInputCapture, STATGROUP_Tickables);
+}
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Tickable.h"
+#include "LightsOutPerWorld.h"
+
+/**
+ * Records the local player's input to a file, or plays a recording back, so the same session can be
+ * run against every build and the LightsOut stats compared. Each frame stores the bound axes and the
+ * held state of the bound actions, changes only, quantized and varint encoded. Both modes run the
+ * engine at a fixed timestep so a frame of input always covers the same game time. For example:
+ *
+ *     UE4Editor "LightsOut.uproject" -game -RecordInput=Session.input
+ *     UE4Editor "LightsOut.uproject" -game -nullrhi -unattended -nosound -ReplayInput=Session.input
+ *
+ * A replay captures the stats like LightsOut.Stats.StartCsv and exits once the recording runs out.
+ */
+class LIGHTSOUT_API FLightsOutInputCapture : public FTickableGameObject
+{
+    public:
+
+        // Starts recording or replaying through the pawn's bindings if the command line asks for it.
+        // Called again when the player gets a new pawn, the capture carries on with it.
+        static void Bind(APawn *Pawn, UInputComponent *InputComponent);
+        // True if the game was started to record or replay input.
+        static bool IsRequested();
+
+        virtual ~FLightsOutInputCapture();
+
+        // FTickableGameObject interface
+        virtual void Tick(float DeltaTime) override;
+        virtual bool IsTickable() const override { return InputComponent.IsValid() && !HasFinished; }
+        virtual TStatId GetStatId() const override;
+
+    private:
+
+        enum class EMode : uint8
+        {
+            Record,
+            Replay
+        };
+
+        FLightsOutInputCapture(EMode InMode, const FString &InFilename);
+
+        bool Open();
+        void RecordFrame();
+        void ReplayFrame();
+        void Finish();
+
+        // The recording is written into a ring buffer each frame and drained to the file in large
+        // blocks, so the game thread only touches the file every few thousand frames.
+        void WriteByte(uint8 Value);
+        void WriteVarint(uint32 Value);
+        void Flush();
+        bool ReadVarint(uint32 &OutValue);
+
+
+    private:
+
+        static const int32 NumAxes = 5;
+        static const int32 NumActions = 2;
+
+        EMode Mode;
+        FString Filename;
+        TWeakObjectPtr<APawn> Pawn;
+        TWeakObjectPtr<UInputComponent> InputComponent;
+        int32 FrameCount;
+        bool HasFinished;
+
+        // Previous frame, which every frame is encoded against.
+        int32 AxisValues[NumAxes];
+        uint8 ActionBits;
+
+        // Recording
+        FArchive *File;
+        TArray<uint8> Ring;
+        uint64 Written;
+        uint64 Flushed;
+
+        // Replay
+        TArray<uint8> Data;
+        int32 Cursor;
+};
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "LightsOutMovementComponent.h"
+#include "LightsOutPerf.h"
+
+ULightsOutMovementComponent::ULightsOutMovementComponent()
+{
+    WantsToSprint = false;
+    SprintMultiplier = 1.0f;
+}
+
+// Runs on the owning client, on the server for each move it receives and for every replayed move, so
+// all of them integrate the sprint the same way.
+void ULightsOutMovementComponent::PerformMovement(float DeltaTime)
+{
+    UpdateSprint(DeltaTime);
+    
+    Super::PerformMovement(DeltaTime);
+}
+
+float ULightsOutMovementComponent::GetMaxSpeed() const
+{
+    const float MaxSpeed = Super::GetMaxSpeed();
+    return MovementMode == MOVE_Walking || MovementMode == MOVE_NavWalking ? MaxSpeed * SprintMultiplier : MaxSpeed;
+}
+
+void ULightsOutMovementComponent::UpdateSprint(float DeltaTime)
+{
+    LIGHTSOUT_SCOPE(UpdateSprint);
+    
+    if(WantsToSprint)
+    {
+        // Sprinting only builds up while the player is trying to move, standing still starts over.
+        const bool IsMoving = !Acceleration.IsNearlyZero();
+        SprintMultiplier = IsMoving ? SprintMultiplier * FMath::Exp(SprintGrowthRate * DeltaTime) : 1.0f;
+    }
+    else if(SprintMultiplier > 1.0f)
+    {
+        SprintMultiplier *= FMath::Exp(-SprintDecayRate * DeltaTime);
+    }
+    
+    SprintMultiplier = FMath::Clamp(SprintMultiplier, 1.0f, MaxSpeedMultiplier);
+}
+
+void ULightsOutMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+    Super::UpdateFromCompressedFlags(Flags);
+    
+    WantsToSprint = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+}
+
+FNetworkPredictionData_Client *ULightsOutMovementComponent::GetPredictionData_Client() const
+{
+    if(ClientPredictionData == nullptr)
+    {
+        ULightsOutMovementComponent *MutableThis = const_cast<ULightsOutMovementComponent*>(this);
+        MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_LightsOut(*this);
+    }
+    return ClientPredictionData;
+}
+
+void FSavedMove_LightsOut::Clear()
+{
+    Super::Clear();
+    
+    SavedWantsToSprint = false;
+    SavedSprintMultiplier = 1.0f;
+}
+
+uint8 FSavedMove_LightsOut::GetCompressedFlags() const
+{
+    uint8 Flags = Super::GetCompressedFlags();
+    if(SavedWantsToSprint)
+    {
+        Flags |= FLAG_Custom_0;
+    }
+    return Flags;
+}
+
+bool FSavedMove_LightsOut::CanCombineWith(const FSavedMovePtr &NewMove, ACharacter *Character, float MaxDelta) const
+{
+    if(SavedWantsToSprint != static_cast<FSavedMove_LightsOut*>(NewMove.Get())->SavedWantsToSprint)
+    {
+        return false;
+    }
+    return Super::CanCombineWith(NewMove, Character, MaxDelta);
+}
+
+void FSavedMove_LightsOut::SetMoveFor(ACharacter *Character, float InDeltaTime, FVector const &NewAccel, FNetworkPredictionData_Client_Character &ClientData)
+{
+    Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+    
+    const ULightsOutMovementComponent *Movement = CastChecked<ULightsOutMovementComponent>(Character->GetCharacterMovement());
+    SavedWantsToSprint = Movement->IsSprinting();
+    SavedSprintMultiplier = Movement->GetSprintMultiplier();
+}
+
+void FSavedMove_LightsOut::PrepMoveFor(ACharacter *Character)
+{
+    Super::PrepMoveFor(Character);
+    
+    ULightsOutMovementComponent *Movement = CastChecked<ULightsOutMovementComponent>(Character->GetCharacterMovement());
+    Movement->SetSprintMultiplier(SavedSprintMultiplier);
+}
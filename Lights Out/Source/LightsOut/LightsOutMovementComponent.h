@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/CharacterMovementComponent.h"
+#include "LightsOutMovementComponent.generated.h"
+
+/**
+ * Character movement with a sprint that builds up while the player keeps moving and winds down after
+ * the sprint is released. The speed follows an exponential curve integrated with the frame's delta
+ * time inside the movement update, so it ramps the same way at any frame rate and responds on the
+ * frame the input changes. Sprinting travels with each move sent to the server, which runs the same
+ * integration, so the server agrees with the client's prediction.
+ */
+UCLASS()
+class LIGHTSOUT_API ULightsOutMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+	
+    public:
+    
+        ULightsOutMovementComponent();
+    
+        virtual float GetMaxSpeed() const override;
+        virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+        virtual class FNetworkPredictionData_Client *GetPredictionData_Client() const override;
+    
+        void SetSprinting(bool Sprinting) { WantsToSprint = Sprinting; }
+        bool IsSprinting() const { return WantsToSprint; }
+    
+        // How many times faster than MaxWalkSpeed the character is currently allowed to move.
+        float GetSprintMultiplier() const { return SprintMultiplier; }
+        void SetSprintMultiplier(float Multiplier) { SprintMultiplier = Multiplier; }
+    
+    protected:
+    
+        virtual void PerformMovement(float DeltaTime) override;
+        void UpdateSprint(float DeltaTime);
+    
+    protected:
+    
+        //Maximum speed multiplier
+        UPROPERTY(EditAnywhere, Category = Sprint, meta = (ClampMin = "1"))
+        float MaxSpeedMultiplier = 4.0f;
+        //Rate the speed grows at while sprinting, per second, the default is 10% every 0.1 seconds
+        UPROPERTY(EditAnywhere, Category = Sprint, meta = (ClampMin = "0"))
+        float SprintGrowthRate = 0.9531f;
+        //Rate the speed decays at after sprinting, per second, the default is 5% every 0.1 seconds
+        UPROPERTY(EditAnywhere, Category = Sprint, meta = (ClampMin = "0"))
+        float SprintDecayRate = 0.5129f;
+    
+    private:
+    
+        bool WantsToSprint;
+        float SprintMultiplier;
+};
+
+// A move saved for client prediction, remembering the sprint so replayed moves speed up the same way.
+class FSavedMove_LightsOut : public FSavedMove_Character
+{
+    public:
+
+        typedef FSavedMove_Character Super;
+
+        virtual void Clear() override;
+        virtual uint8 GetCompressedFlags() const override;
+        virtual bool CanCombineWith(const FSavedMovePtr &NewMove, ACharacter *Character, float MaxDelta) const override;
+        virtual void SetMoveFor(ACharacter *Character, float InDeltaTime, FVector const &NewAccel, class FNetworkPredictionData_Client_Character &ClientData) override;
+        virtual void PrepMoveFor(ACharacter *Character) override;
+
+    private:
+
+        bool SavedWantsToSprint;
+        float SavedSprintMultiplier;
+};
+
+class FNetworkPredictionData_Client_LightsOut : public FNetworkPredictionData_Client_Character
+{
+    public:
+
+        typedef FNetworkPredictionData_Client_Character Super;
+
+        explicit FNetworkPredictionData_Client_LightsOut(const UCharacterMovementComponent &ClientMovement) : Super(ClientMovement) {}
+
+        virtual FSavedMovePtr AllocateNewMove() override { return FSavedMovePtr(new FSavedMove_LightsOut()); }
+};
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * One instance of a system per world. Instances are created on first use and deleted when their
+ * world is cleaned up, so a system never outlives its world or leaves a stale entry keyed by it.
+ * T is constructed from the world, systems with a private constructor befriend this class.
+ */
+template<typename T>
+class TLightsOutPerWorld
+{
+    public:
+
+        // Returns the world's instance, creating it if needed.
+        static T *Get(UWorld *World)
+        {
+            check(World);
+            T *&Instance = GetInstances().FindOrAdd(World);
+            if(Instance == nullptr)
+            {
+                BindCleanup();
+                Instance = new T(World);
+            }
+            return Instance;
+        }
+
+        // Returns the world's instance or nullptr if it has none.
+        static T *Find(const UWorld *World)
+        {
+            return GetInstances().FindRef(World);
+        }
+
+        // Hands an instance the caller created to the world, for systems that are not always created.
+        static void Add(UWorld *World, T *Instance)
+        {
+            check(World && !GetInstances().Contains(World));
+            BindCleanup();
+            GetInstances().Add(World, Instance);
+        }
+
+    private:
+
+        static TMap<const UWorld*, T*> &GetInstances()
+        {
+            static TMap<const UWorld*, T*> Instances;
+            return Instances;
+        }
+
+        static void BindCleanup()
+        {
+            static bool IsCleanupBound = false;
+            if(!IsCleanupBound)
+            {
+                FWorldDelegates::OnWorldCleanup.AddStatic(&TLightsOutPerWorld::OnWorldCleanup);
+                IsCleanupBound = true;
+            }
+        }
+
+        static void OnWorldCleanup(UWorld *World, bool SessionEnded, bool CleanupResources)
+        {
+            T *Instance = nullptr;
+            if(GetInstances().RemoveAndCopyValue(World, Instance))
+            {
+                delete Instance;
+            }
+        }
+};
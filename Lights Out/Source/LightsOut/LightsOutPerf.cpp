@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "LightsOutPerf.h"
+#include "Json.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+
+DEFINE_STAT(STAT_LightsOut_CastLight);
+DEFINE_STAT(STAT_LightsOut_LerpLight);
+DEFINE_STAT(STAT_LightsOut_CheckSequence);
+DEFINE_STAT(STAT_LightsOut_ResetPuzzle);
+DEFINE_STAT(STAT_LightsOut_UpdateSprint);
+DEFINE_STAT(STAT_LightsOut_PlaySound);
+DEFINE_STAT(STAT_LightsOut_SaveCheckpoint);
+DEFINE_STAT(STAT_LightsOut_RestoreCheckpoint);
+
+DEFINE_STAT(STAT_LightsOut_CastLightCalls);
+DEFINE_STAT(STAT_LightsOut_LerpLightCalls);
+DEFINE_STAT(STAT_LightsOut_CheckSequenceCalls);
+DEFINE_STAT(STAT_LightsOut_ResetPuzzleCalls);
+DEFINE_STAT(STAT_LightsOut_UpdateSprintCalls);
+DEFINE_STAT(STAT_LightsOut_PlaySoundCalls);
+DEFINE_STAT(STAT_LightsOut_SaveCheckpointCalls);
+DEFINE_STAT(STAT_LightsOut_RestoreCheckpointCalls);
+
+DEFINE_STAT(STAT_LightsOut_LightCurveMemory);
+DEFINE_STAT(STAT_LightsOut_BeamMemory);
+DEFINE_STAT(STAT_LightsOut_AudioVoiceMemory);
+
+static FAutoConsoleCommand StartCsvCommand(
+    TEXT("LightsOut.Stats.StartCsv"),
+    TEXT("Starts recording the LightsOut scopes for a CSV export."),
+    FConsoleCommandDelegate::CreateStatic(&FLightsOutPerf::StartCapture));
+
+static FAutoConsoleCommand StopCsvCommand(
+    TEXT("LightsOut.Stats.StopCsv"),
+    TEXT("Stops recording and writes a summary of each LightsOut scope to Saved/Profiling."),
+    FConsoleCommandDelegate::CreateStatic(&FLightsOutPerf::StopCapture));
+
+// Logs the traffic of every connection, which on a listen server is the bandwidth spent on each player.
+static void ReportNetBandwidth(UWorld *World)
+{
+    UNetDriver *NetDriver = World ? World->GetNetDriver() : nullptr;
+    if(NetDriver == nullptr)
+    {
+        UE_LOG(LogLightsOut, Display, TEXT("NetReport: the world is not networked"));
+        return;
+    }
+    
+    TArray<UNetConnection*> Connections = NetDriver->ClientConnections;
+    if(NetDriver->ServerConnection)
+    {
+        Connections.Add(NetDriver->ServerConnection);
+    }
+    
+    for(UNetConnection *Connection : Connections)
+    {
+        const APlayerController *PlayerController = Connection->PlayerController;
+        const FString Name = PlayerController && PlayerController->PlayerState ? PlayerController->PlayerState->PlayerName : Connection->LowLevelGetRemoteAddress();
+        UE_LOG(LogLightsOut, Display, TEXT("NetReport: %s out %d B/s (%d packets/s), in %d B/s (%d packets/s)"),
+            *Name, Connection->OutBytesPerSecond, Connection->OutPacketsPerSecond, Connection->InBytesPerSecond, Connection->InPacketsPerSecond);
+    }
+}
+
+static FAutoConsoleCommandWithWorld NetReportCommand(
+    TEXT("LightsOut.NetReport"),
+    TEXT("Logs the bandwidth used by each network connection."),
+    FConsoleCommandWithWorldDelegate::CreateStatic(&ReportNetBandwidth));
+
+TMap<FName, TArray<float>> FLightsOutPerf::Tracks;
+bool FLightsOutPerf::IsCapturing = false;
+
+bool FLightsOutPerf::IsGateEnabled()
+{
+    static const bool Enabled = FParse::Param(FCommandLine::Get(), TEXT("PerfGate"));
+    return Enabled;
+}
+
+void FLightsOutPerf::Record(FName Track, float Milliseconds)
+{
+    Tracks.FindOrAdd(Track).Add(Milliseconds);
+}
+
+void FLightsOutPerf::Reset()
+{
+    Tracks.Empty();
+}
+
+bool FLightsOutPerf::CheckBudget(const FString &BudgetFile)
+{
+    FString Contents;
+    if(!FFileHelper::LoadFileToString(Contents, *BudgetFile))
+    {
+        UE_LOG(LogLightsOut, Error, TEXT("PerfGate: could not read the budget file %s"), *BudgetFile);
+        return false;
+    }
+
+    TSharedPtr<FJsonObject> Budget;
+    if(!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Contents), Budget) || !Budget.IsValid())
+    {
+        UE_LOG(LogLightsOut, Error, TEXT("PerfGate: %s is not valid JSON"), *BudgetFile);
+        return false;
+    }
+
+    bool Passed = true;
+    for(const auto &Entry : Budget->Values)
+    {
+        const TSharedPtr<FJsonObject> *Limits = nullptr;
+        if(!Entry.Value->TryGetObject(Limits)) { continue; }
+
+        TArray<float> *Samples = Tracks.Find(FName(*Entry.Key));
+        if(Samples == nullptr || Samples->Num() == 0)
+        {
+            UE_LOG(LogLightsOut, Error, TEXT("PerfGate: %s recorded no samples"), *Entry.Key);
+            Passed = false;
+            continue;
+        }
+
+        float Average, Median, P95, Max;
+        Summarize(*Samples, Average, Median, P95, Max);
+
+        // A missing limit is treated as unbounded.
+        double AverageLimit = BIG_NUMBER;
+        double P95Limit = BIG_NUMBER;
+        (*Limits)->TryGetNumberField(TEXT("AverageMs"), AverageLimit);
+        (*Limits)->TryGetNumberField(TEXT("P95Ms"), P95Limit);
+
+        const bool TrackPassed = Average <= AverageLimit && P95 <= P95Limit;
+        if(TrackPassed)
+        {
+            UE_LOG(LogLightsOut, Display, TEXT("PerfGate: %s passed, %d samples, average %.3f ms (budget %.3f), p95 %.3f ms (budget %.3f)"),
+                *Entry.Key, Samples->Num(), Average, AverageLimit, P95, P95Limit);
+        }
+        else
+        {
+            UE_LOG(LogLightsOut, Error, TEXT("PerfGate: %s over budget, %d samples, average %.3f ms (budget %.3f), p95 %.3f ms (budget %.3f)"),
+                *Entry.Key, Samples->Num(), Average, AverageLimit, P95, P95Limit);
+        }
+        Passed &= TrackPassed;
+    }
+    return Passed;
+}
+
+void FLightsOutPerf::StartCapture()
+{
+    if(!IsGateEnabled())
+    {
+        Reset();
+    }
+    IsCapturing = true;
+}
+
+void FLightsOutPerf::StopCapture()
+{
+    if(!IsCapturing) { return; }
+    IsCapturing = false;
+
+    // One row per scope, so the files from two builds can be compared side by side.
+    FString Csv = TEXT("Scope,Calls,AverageMs,MedianMs,P95Ms,MaxMs,TotalMs\n");
+    for(auto &Track : Tracks)
+    {
+        if(Track.Value.Num() == 0) { continue; }
+
+        float Average, Median, P95, Max;
+        Summarize(Track.Value, Average, Median, P95, Max);
+        Csv += FString::Printf(TEXT("%s,%d,%.4f,%.4f,%.4f,%.4f,%.4f\n"),
+            *Track.Key.ToString(), Track.Value.Num(), Average, Median, P95, Max, Average * Track.Value.Num());
+    }
+
+    const FString FileName = FPaths::ProfilingDir() / FString::Printf(TEXT("LightsOut-%s.csv"), *FDateTime::Now().ToString());
+    if(FFileHelper::SaveStringToFile(Csv, *FileName))
+    {
+        UE_LOG(LogLightsOut, Display, TEXT("Wrote LightsOut stats to %s"), *FileName);
+    }
+    else
+    {
+        UE_LOG(LogLightsOut, Error, TEXT("Could not write LightsOut stats to %s"), *FileName);
+    }
+
+    if(!IsGateEnabled())
+    {
+        Reset();
+    }
+}
+
+void FLightsOutPerf::Summarize(TArray<float> &Samples, float &OutAverage, float &OutMedian, float &OutP95, float &OutMax)
+{
+    Samples.Sort();
+    float Total = 0;
+    for(float Sample : Samples)
+    {
+        Total += Sample;
+    }
+
+    const int32 Last = Samples.Num() - 1;
+    OutAverage = Total / Samples.Num();
+    OutMedian = Samples[Last / 2];
+    OutP95 = Samples[FMath::Min(FMath::FloorToInt(Samples.Num() * 0.95f), Last)];
+    OutMax = Samples[Last];
+}
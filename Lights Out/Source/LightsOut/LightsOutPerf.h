@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CastLight"), STAT_LightsOut_CastLight, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("LerpLight"), STAT_LightsOut_LerpLight, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CheckSequence"), STAT_LightsOut_CheckSequence, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ResetPuzzle"), STAT_LightsOut_ResetPuzzle, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateSprint"), STAT_LightsOut_UpdateSprint, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PlaySound"), STAT_LightsOut_PlaySound, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SaveCheckpoint"), STAT_LightsOut_SaveCheckpoint, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RestoreCheckpoint"), STAT_LightsOut_RestoreCheckpoint, STATGROUP_LightsOut, LIGHTSOUT_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("CastLight Calls"), STAT_LightsOut_CastLightCalls, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("LerpLight Calls"), STAT_LightsOut_LerpLightCalls, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("CheckSequence Calls"), STAT_LightsOut_CheckSequenceCalls, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("ResetPuzzle Calls"), STAT_LightsOut_ResetPuzzleCalls, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("UpdateSprint Calls"), STAT_LightsOut_UpdateSprintCalls, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("PlaySound Calls"), STAT_LightsOut_PlaySoundCalls, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("SaveCheckpoint Calls"), STAT_LightsOut_SaveCheckpointCalls, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("RestoreCheckpoint Calls"), STAT_LightsOut_RestoreCheckpointCalls, STATGROUP_LightsOut, LIGHTSOUT_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Light Curves"), STAT_LightsOut_LightCurveMemory, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Beam Queries"), STAT_LightsOut_BeamMemory, STATGROUP_LightsOut, LIGHTSOUT_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Audio Voices"), STAT_LightsOut_AudioVoiceMemory, STATGROUP_LightsOut, LIGHTSOUT_API);
+
+// Times the enclosing block under the LightsOut cycle stat and call counter of the same name, which
+// shows it in "stat LightsOut" and in profiler captures, and records it for the perf gate and CSV capture.
+#define LIGHTSOUT_SCOPE(Name) \
+    SCOPE_CYCLE_COUNTER(STAT_LightsOut_##Name); \
+    INC_DWORD_STAT(STAT_LightsOut_##Name##Calls); \
+    static const FName LightsOutTrack_##Name = FName(TEXT(#Name)); \
+    FLightsOutPerfScope LightsOutPerfScope_##Name(LightsOutTrack_##Name)
+
+// Keeps a memory stat in step with a size that changes over time, so several owners can share the stat.
+#define LIGHTSOUT_TRACK_MEMORY(Stat, ReportedSize, NewSize) \
+    { \
+        const int64 LightsOutNewSize = (NewSize); \
+        if(LightsOutNewSize > ReportedSize) { INC_MEMORY_STAT_BY(Stat, LightsOutNewSize - ReportedSize); } \
+        else { DEC_MEMORY_STAT_BY(Stat, ReportedSize - LightsOutNewSize); } \
+        ReportedSize = LightsOutNewSize; \
+    }
+
+/**
+ * Collects timings for the headless performance gate and checks them against a budget file, or
+ * writes them to a CSV for comparing builds. Nothing is recorded unless the game was started with
+ * -PerfGate or a capture is running, so the scopes cost one branch otherwise.
+ */
+class LIGHTSOUT_API FLightsOutPerf
+{
+    public:
+
+        static bool IsEnabled() { return IsGateEnabled() || IsCapturing; }
+        static bool IsGateEnabled();
+
+        static void Record(FName Track, float Milliseconds);
+        static void Reset();
+
+        // Compares every track named in the budget file against its average and 95th percentile
+        // limits, logging each one. Returns false if any limit is exceeded or a track has no samples.
+        static bool CheckBudget(const FString &BudgetFile);
+
+        // CSV capture, driven by the LightsOut.Stats.StartCsv and LightsOut.Stats.StopCsv commands.
+        static void StartCapture();
+        static void StopCapture();
+
+    private:
+
+        static void Summarize(TArray<float> &Samples, float &OutAverage, float &OutMedian, float &OutP95, float &OutMax);
+
+        static TMap<FName, TArray<float>> Tracks;
+        static bool IsCapturing;
+};
+
+// Records the time spent in the enclosing block under the track.
+class FLightsOutPerfScope
+{
+    public:
+
+        explicit FLightsOutPerfScope(FName InTrack)
+            : Track(InTrack)
+            , StartCycles(FLightsOutPerf::IsEnabled() ? FPlatformTime::Cycles() : 0)
+        {
+        }
+
+        ~FLightsOutPerfScope()
+        {
+            if(FLightsOutPerf::IsEnabled())
+            {
+                FLightsOutPerf::Record(Track, FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - StartCycles));
+            }
+        }
+
+    private:
+
+        FName Track;
+        uint32 StartCycles;
+};
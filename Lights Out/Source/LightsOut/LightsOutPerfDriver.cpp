@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "LightsOutPerfDriver.h"
+#include "LightsOutPerf.h"
+#include "LightsOutCharacter.h"
+#include "Flashlight.h"
+#include "SoundGem.h"
+
+ALightsOutPerfDriver::ALightsOutPerfDriver()
+{
+    PrimaryActorTick.bCanEverTick = true;
+}
+
+void ALightsOutPerfDriver::BeginPlay()
+{
+    Super::BeginPlay();
+    
+    if(!FLightsOutPerf::IsGateEnabled() || Character == nullptr || Character->Controller == nullptr)
+    {
+        SetActorTickEnabled(false);
+        return;
+    }
+    
+    FLightsOutPerf::Reset();
+    Phase = ELightsOutPerfPhase::Warmup;
+    PhaseStartTime = GetWorld()->GetTimeSeconds();
+    StartRotation = Character->Controller->GetControlRotation();
+    NextGem = 0;
+    HasSolveFailed = false;
+}
+
+void ALightsOutPerfDriver::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+    
+    if(Phase != ELightsOutPerfPhase::Warmup)
+    {
+        FLightsOutPerf::Record(TEXT("GameThread"), FPlatformTime::ToMilliseconds(GGameThreadTime));
+    }
+    
+    const float PhaseTime = GetWorld()->GetTimeSeconds() - PhaseStartTime;
+    switch(Phase)
+    {
+        case ELightsOutPerfPhase::Warmup:
+            // The flashlight starts switched off and the character may spawn it after this actor's
+            // BeginPlay, so it is switched on here once it exists.
+            SwitchOnFlashlight();
+            if(PhaseTime >= WarmupTime)
+            {
+                Phase = ELightsOutPerfPhase::Sweep;
+                PhaseStartTime = GetWorld()->GetTimeSeconds();
+            }
+            break;
+        case ELightsOutPerfPhase::Sweep:
+            UpdateSweep();
+            if(PhaseTime >= SweepTime)
+            {
+                Phase = ELightsOutPerfPhase::Solve;
+                PhaseStartTime = GetWorld()->GetTimeSeconds();
+            }
+            break;
+        case ELightsOutPerfPhase::Solve:
+            UpdateSolve();
+            break;
+        default:
+            break;
+    }
+}
+
+void ALightsOutPerfDriver::UpdateSweep()
+{
+    const float PhaseTime = GetWorld()->GetTimeSeconds() - PhaseStartTime;
+    FRotator Rotation = StartRotation;
+    Rotation.Yaw += SweepYaw * FMath::Sin(2.0f * PI * PhaseTime / FMath::Max(SweepPeriod, KINDA_SMALL_NUMBER));
+    Character->Controller->SetControlRotation(Rotation);
+}
+
+// Aims at each gem in turn and records how long it takes to light up, which covers the beam query,
+// the dwell time and the room checking the sequence.
+void ALightsOutPerfDriver::UpdateSolve()
+{
+    if(NextGem >= SolveOrder.Num())
+    {
+        Finish();
+        return;
+    }
+    
+    // Lighting a gem next to the one aimed at breaks the sequence and puts the earlier gems out, which
+    // the stress map checks by placing gems side by side.
+    for(int32 Index = 0; Index < NextGem; Index++)
+    {
+        if(SolveOrder[Index] && !SolveOrder[Index]->IsSolved())
+        {
+            UE_LOG(LogLightsOut, Error, TEXT("PerfGate: %s went out while aiming at the next gem, the beam lit a neighbour"), *SolveOrder[Index]->GetName());
+            HasSolveFailed = true;
+            Finish();
+            return;
+        }
+    }
+    
+    ASoundGem *Gem = SolveOrder[NextGem];
+    const float AimTime = GetWorld()->GetTimeSeconds() - PhaseStartTime;
+    if(Gem == nullptr || Gem->IsSolved())
+    {
+        if(Gem)
+        {
+            FLightsOutPerf::Record(TEXT("PuzzleEvent"), AimTime * 1000.0f);
+        }
+        NextGem++;
+        PhaseStartTime = GetWorld()->GetTimeSeconds();
+        return;
+    }
+    
+    if(AimTime > GemTimeout)
+    {
+        UE_LOG(LogLightsOut, Error, TEXT("PerfGate: %s did not light up within %.1f seconds"), *Gem->GetName(), GemTimeout);
+        HasSolveFailed = true;
+        Finish();
+        return;
+    }
+    
+    AimAt(Gem->GetActorLocation());
+}
+
+void ALightsOutPerfDriver::SwitchOnFlashlight()
+{
+    AFlashlight *Flashlight = Character->GetFlashlight();
+    if(Flashlight && !Flashlight->IsLightOn())
+    {
+        Flashlight->ToggleLight();
+    }
+}
+
+void ALightsOutPerfDriver::AimAt(const FVector &Location)
+{
+    FVector ViewLocation;
+    FRotator ViewRotation;
+    Character->Controller->GetPlayerViewPoint(ViewLocation, ViewRotation);
+    Character->Controller->SetControlRotation((Location - ViewLocation).Rotation());
+}
+
+void ALightsOutPerfDriver::Finish()
+{
+    Phase = ELightsOutPerfPhase::Done;
+    SetActorTickEnabled(false);
+    
+    const FString BudgetFile = FPaths::GameConfigDir() / TEXT("PerfBudget.json");
+    const bool Passed = FLightsOutPerf::CheckBudget(BudgetFile) && !HasSolveFailed;
+    if(Passed)
+    {
+        UE_LOG(LogLightsOut, Display, TEXT("PerfGate: PASSED"));
+    }
+    else
+    {
+        UE_LOG(LogLightsOut, Error, TEXT("PerfGate: FAILED"));
+    }
+    
+    // A failed run has to leave a nonzero exit code for CI. A normal exit always returns 0, so the
+    // process is flagged as having hit a critical error and torn down straight away instead.
+    if(!Passed)
+    {
+        GIsCriticalError = true;
+        GLog->Flush();
+        FPlatformMisc::RequestExit(true);
+        return;
+    }
+    FPlatformMisc::RequestExit(false);
+}
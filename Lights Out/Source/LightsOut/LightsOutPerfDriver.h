@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "LightsOutPerfDriver.generated.h"
+
+enum class ELightsOutPerfPhase : uint8
+{
+    Warmup,
+    Sweep,
+    Solve,
+    Done
+};
+
+/**
+ * Plays through a stress map on its own for the headless performance gate. The character sweeps the
+ * flashlight back and forth across the room, then aims at the gems in order to solve the puzzle, and
+ * the recorded timings are checked against Config/PerfBudget.json before the game exits, with a nonzero
+ * exit code if they are over budget. Does nothing unless the game was started with -PerfGate, for example:
+ *
+ *     UE4Editor "LightsOut.uproject" PerfMap -game -nullrhi -unattended -nosound -PerfGate
+ */
+UCLASS()
+class LIGHTSOUT_API ALightsOutPerfDriver : public AActor
+{
+	GENERATED_BODY()
+	
+    public:
+    
+        ALightsOutPerfDriver();
+        virtual void BeginPlay() override;
+        virtual void Tick(float DeltaSeconds) override;
+    
+    protected:
+    
+        void UpdateSweep();
+        void UpdateSolve();
+        void SwitchOnFlashlight();
+        void AimAt(const FVector &Location);
+        void Finish();
+    
+    protected:
+    
+        UPROPERTY(EditAnywhere, Category = Perf)
+        class ALightsOutCharacter *Character;
+    
+        //Gems in the order that solves the room
+        UPROPERTY(EditAnywhere, Category = Perf)
+        TArray<class ASoundGem*> SolveOrder;
+    
+        //Frames this long after the map loads are not recorded
+        UPROPERTY(EditAnywhere, Category = Perf)
+        float WarmupTime = 2.0f;
+        UPROPERTY(EditAnywhere, Category = Perf)
+        float SweepTime = 20.0f;
+        //Degrees the view swings to each side of where it started
+        UPROPERTY(EditAnywhere, Category = Perf)
+        float SweepYaw = 60.0f;
+        //Seconds for one full swing back and forth
+        UPROPERTY(EditAnywhere, Category = Perf)
+        float SweepPeriod = 4.0f;
+        //Longest a gem may take to light up once aimed at before the run fails
+        UPROPERTY(EditAnywhere, Category = Perf)
+        float GemTimeout = 2.0f;
+    
+    private:
+    
+        ELightsOutPerfPhase Phase;
+        float PhaseStartTime;
+        FRotator StartRotation;
+        int32 NextGem;
+        bool HasSolveFailed;
+};
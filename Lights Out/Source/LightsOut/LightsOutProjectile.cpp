@@ -3,6 +3,7 @@
 #include "LightsOut.h"
 #include "LightsOutProjectile.h"
 #include "GameFramework/ProjectileMovementComponent.h"
+#include "ProjectilePool.h"
 
 ALightsOutProjectile::ALightsOutProjectile() 
 {
@@ -29,6 +30,8 @@ ALightsOutProjectile::ALightsOutProjectile()
 
 	// Die after 3 seconds by default
 	InitialLifeSpan = 3.0f;
+
+	OwningPool = NULL;
 }
 
 void ALightsOutProjectile::OnHit(AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
@@ -38,6 +41,47 @@ void ALightsOutProjectile::OnHit(AActor* OtherActor, UPrimitiveComponent* OtherC
 	{
 		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
 
+		Expire();
+	}
+}
+
+void ALightsOutProjectile::LaunchFromPool(const FVector& Location, const FRotator& Rotation)
+{
+	SetActorLocationAndRotation(Location, Rotation);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	// Pooled projectiles keep their lifetime on a timer so they come back to the pool instead of being destroyed
+	SetLifeSpan(0.0f);
+	GetWorldTimerManager().SetTimer(LifeSpanTimer, this, &ALightsOutProjectile::Expire, InitialLifeSpan, false);
+
+	// The movement component may have stopped simulating and let go of its updated component after a bounce
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+	ProjectileMovement->Velocity = Rotation.Vector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->UpdateComponentVelocity();
+	ProjectileMovement->SetComponentTickEnabled(true);
+}
+
+void ALightsOutProjectile::DeactivateToPool()
+{
+	GetWorldTimerManager().ClearTimer(LifeSpanTimer);
+	SetLifeSpan(0.0f);
+
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->SetComponentTickEnabled(false);
+
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
+}
+
+void ALightsOutProjectile::Expire()
+{
+	if (OwningPool != NULL)
+	{
+		OwningPool->Release(this);
+	}
+	else
+	{
 		Destroy();
 	}
 }
\ No newline at end of file
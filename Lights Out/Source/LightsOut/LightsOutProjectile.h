@@ -23,9 +23,26 @@ public:
 	UFUNCTION()
 	void OnHit(AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/** Puts the projectile back in flight from its pool */
+	void LaunchFromPool(const FVector& Location, const FRotator& Rotation);
+
+	/** Stops and hides the projectile until its pool launches it again */
+	void DeactivateToPool();
+
+	void SetOwningPool(class UProjectilePool* Pool) { OwningPool = Pool; }
+
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
 	FORCEINLINE class UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+private:
+	/** Returns a pooled projectile to its pool, or destroys one that was spawned on its own */
+	void Expire();
+
+	/** Pool this projectile is recycled into, if any */
+	class UProjectilePool* OwningPool;
+
+	FTimerHandle LifeSpanTimer;
 };
 
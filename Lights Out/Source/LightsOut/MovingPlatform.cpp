@@ -7,8 +7,8 @@
 // Sets default values
 AMovingPlatform::AMovingPlatform()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Nothing moves the platform per frame yet, so it does not tick.
+	PrimaryActorTick.bCanEverTick = false;
 
 }
 
@@ -19,10 +19,3 @@ void AMovingPlatform::BeginPlay()
 	
 }
 
-// Called every frame
-void AMovingPlatform::Tick( float DeltaTime )
-{
-	Super::Tick( DeltaTime );
-
-}
-
@@ -0,0 +1,115 @@
+// Copyright 1998-2015 Epic Games, Inc. All Rights Reserved.
+
+#include "LightsOut.h"
+#include "ProjectilePool.h"
+#include "LightsOutProjectile.h"
+
+void UProjectilePool::Initialize(AActor* InOwner, TSubclassOf<ALightsOutProjectile> InProjectileClass, int32 PrewarmCount, int32 InMaxCount)
+{
+	Owner = InOwner;
+	ProjectileClass = InProjectileClass;
+	MaxCount = FMath::Max(InMaxCount, 1);
+	Requests = Reuses = Spawns = Recycles = 0;
+
+	const int32 Count = FMath::Min(PrewarmCount, MaxCount);
+	Available.Reserve(Count);
+	Active.Reserve(Count);
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		ALightsOutProjectile* Projectile = SpawnProjectile();
+		if (Projectile != NULL)
+		{
+			Available.Add(Projectile);
+		}
+	}
+	// The prewarmed projectiles do not count as misses
+	Spawns = 0;
+}
+
+ALightsOutProjectile* UProjectilePool::Fire(const FVector& Location, const FRotator& Rotation)
+{
+	Requests++;
+
+	ALightsOutProjectile* Projectile = NULL;
+	if (Available.Num() > 0)
+	{
+		Projectile = Available.Pop(false);
+		Reuses++;
+	}
+	else if (GetPoolSize() < MaxCount)
+	{
+		Projectile = SpawnProjectile();
+	}
+	else if (Active.Num() > 0)
+	{
+		// Out of projectiles, so the one that has been flying the longest is taken back
+		Projectile = Active[0];
+		Active.RemoveAt(0, 1, false);
+		Projectile->DeactivateToPool();
+		Recycles++;
+	}
+
+	if (Projectile != NULL)
+	{
+		Active.Add(Projectile);
+		Projectile->LaunchFromPool(Location, Rotation);
+	}
+	return Projectile;
+}
+
+void UProjectilePool::Release(ALightsOutProjectile* Projectile)
+{
+	if (Active.RemoveSingle(Projectile) > 0)
+	{
+		Projectile->DeactivateToPool();
+		Available.Add(Projectile);
+	}
+}
+
+void UProjectilePool::Empty()
+{
+	for (ALightsOutProjectile* Projectile : Available)
+	{
+		if (Projectile != NULL)
+		{
+			Projectile->Destroy();
+		}
+	}
+	for (ALightsOutProjectile* Projectile : Active)
+	{
+		if (Projectile != NULL)
+		{
+			Projectile->Destroy();
+		}
+	}
+	Available.Empty();
+	Active.Empty();
+}
+
+void UProjectilePool::LogStats() const
+{
+	UE_LOG(LogLightsOut, Log, TEXT("Projectile pool: size %d (%d in flight), %d shots, hit rate %.2f, %d spawned, %d recycled in flight"),
+		GetPoolSize(), Active.Num(), Requests, GetHitRate(), Spawns, Recycles);
+}
+
+ALightsOutProjectile* UProjectilePool::SpawnProjectile()
+{
+	UWorld* const World = Owner != NULL ? Owner->GetWorld() : NULL;
+	if (World == NULL || ProjectileClass == NULL)
+	{
+		return NULL;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Owner = Owner;
+	SpawnParameters.bNoCollisionFail = true;
+
+	ALightsOutProjectile* Projectile = World->SpawnActor<ALightsOutProjectile>(ProjectileClass, Owner->GetActorLocation(), FRotator::ZeroRotator, SpawnParameters);
+	if (Projectile != NULL)
+	{
+		Projectile->SetOwningPool(this);
+		Projectile->DeactivateToPool();
+		Spawns++;
+	}
+	return Projectile;
+}
@@ -0,0 +1,56 @@
+// Copyright 1998-2015 Epic Games, Inc. All Rights Reserved.
+#pragma once
+#include "ProjectilePool.generated.h"
+
+class ALightsOutProjectile;
+
+/**
+ * Keeps a set of projectiles spawned up front and recycles them when they hit something or their
+ * lifetime runs out, so firing does not construct a new actor each shot.
+ */
+UCLASS()
+class UProjectilePool : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Spawns the first PrewarmCount projectiles, the pool grows up to MaxCount after that */
+	void Initialize(AActor* InOwner, TSubclassOf<ALightsOutProjectile> InProjectileClass, int32 PrewarmCount, int32 InMaxCount);
+
+	/** Launches a projectile from the pool, recycling the oldest one in flight if the pool is exhausted */
+	ALightsOutProjectile* Fire(const FVector& Location, const FRotator& Rotation);
+
+	/** Puts a projectile back in the pool */
+	void Release(ALightsOutProjectile* Projectile);
+
+	/** Destroys every projectile owned by the pool */
+	void Empty();
+
+	/** Returns the share of shots that reused a pooled projectile instead of spawning one */
+	UFUNCTION(BlueprintPure, Category = Projectile)
+	float GetHitRate() const { return Requests > 0 ? float(Reuses) / Requests : 0.0f; }
+
+	UFUNCTION(BlueprintPure, Category = Projectile)
+	int32 GetPoolSize() const { return Available.Num() + Active.Num(); }
+
+	void LogStats() const;
+
+private:
+	ALightsOutProjectile* SpawnProjectile();
+
+	UPROPERTY(Transient)
+	TArray<ALightsOutProjectile*> Available;
+
+	/** Projectiles in flight, oldest first */
+	UPROPERTY(Transient)
+	TArray<ALightsOutProjectile*> Active;
+
+	AActor* Owner;
+	TSubclassOf<ALightsOutProjectile> ProjectileClass;
+	int32 MaxCount;
+
+	int32 Requests;
+	int32 Reuses;
+	int32 Spawns;
+	int32 Recycles;
+};
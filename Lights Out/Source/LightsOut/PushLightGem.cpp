@@ -2,13 +2,16 @@
 
 #include "LightsOut.h"
 #include "PushLightGem.h"
+#include "LightsOutGameInstance.h"
+#include "GemLightBudget.h"
+#include "LightExposureGrid.h"
 
 
 // Sets default values
 APushLightGem::APushLightGem()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// The gem only reacts to events, so it never needs to tick.
+	PrimaryActorTick.bCanEverTick = false;
 
 	GemMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("GemMesh"));
 	RootComponent = GemMesh;
@@ -21,6 +24,13 @@ APushLightGem::APushLightGem()
 }
 
 // Called when the game starts or when spawned
+void APushLightGem::PostLoad()
+{
+	Super::PostLoad();
+
+	ULightsOutGameInstance::MigrateReference(pitch_DEPRECATED, PitchSound);
+}
+
 void APushLightGem::BeginPlay()
 {
 	Super::BeginPlay();
@@ -28,12 +38,30 @@ void APushLightGem::BeginPlay()
 	m_IsShining = true;
 	PointLightComponent->SetIntensity(LightIntensity);
 	PointLightComponent->SetLightColor(LightColor, true);
+
+	// Gameplay asks the grid how lit an area is, on every machine whatever the light budget does.
+	FLightExposureGrid::Get(GetWorld())->Register(PointLightComponent);
+
+	// The budget decides whether the light is rendered for real or faked on the gem's mesh.
+	if (!IsRunningDedicatedServer())
+	{
+		FGemLightBudget::Get(GetWorld())->Register(PointLightComponent, GemMesh);
+	}
 }
 
-// Called every frame
-void APushLightGem::Tick( float DeltaTime )
+void APushLightGem::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick( DeltaTime );
+	FGemLightBudget *LightBudget = FGemLightBudget::Find(GetWorld());
+	if (LightBudget)
+	{
+		LightBudget->Unregister(PointLightComponent);
+	}
+	FLightExposureGrid *ExposureGrid = FLightExposureGrid::Find(GetWorld());
+	if (ExposureGrid)
+	{
+		ExposureGrid->Unregister(PointLightComponent);
+	}
 
+	Super::EndPlay(EndPlayReason);
 }
 
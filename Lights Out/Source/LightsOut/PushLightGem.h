@@ -14,18 +14,22 @@ public:
 	// Sets default values for this actor's properties
 	APushLightGem();
 
+	virtual void PostLoad() override;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
-	
-	// Called every frame
-	virtual void Tick( float DeltaSeconds ) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 protected:
 	UPROPERTY(VisibleDefaultsOnly, Category = Components)
 		UStaticMeshComponent *GemMesh;
 
 	UPROPERTY(EditDefaultsOnly, Category = Sound)
-	class USoundCue* pitch;
+	TAssetPtr<class USoundCue> PitchSound;
+
+	/** Hard reference from before the sound was loaded softly, moved over in PostLoad() */
+	UPROPERTY()
+	class USoundCue* pitch_DEPRECATED;
 
 	UPROPERTY(EditDefaultsOnly, Category = Light)
 		UPointLightComponent *PointLightComponent;
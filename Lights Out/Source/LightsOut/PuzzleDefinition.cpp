@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LightsOut.h"
+#include "PuzzleDefinition.h"
+
+void UPuzzleDefinition::Compile()
+{
+    std::vector<std::vector<int>> Patterns;
+    Patterns.reserve(AcceptedPatterns.Num());
+    for(const FPuzzlePattern &Pattern : AcceptedPatterns)
+    {
+        Patterns.push_back(std::vector<int>(Pattern.GemSequence.GetData(), Pattern.GemSequence.GetData() + Pattern.GemSequence.Num()));
+    }
+    
+    LightsOutCore::CompiledPuzzle Compiled;
+    if(!LightsOutCore::CompilePuzzle(Patterns, RestartFromMismatch, Compiled))
+    {
+        UE_LOG(LogLightsOut, Error, TEXT("%s has more puzzle states than a transition can address"), *GetName());
+    }
+    
+    NumGems = Compiled.NumGems;
+    MaxDepth = Compiled.MaxDepth;
+    MismatchTransition = Compiled.MismatchTransition;
+    Transitions = TArray<uint16>(Compiled.Transitions.data(), int32(Compiled.Transitions.size()));
+    StateDepths = TArray<uint8>(Compiled.StateDepths.data(), int32(Compiled.StateDepths.size()));
+}
+
+void UPuzzleDefinition::PreSave()
+{
+    Super::PreSave();
+
+    // Saving and cooking both go through here, so shipped assets always carry a fresh table.
+    Compile();
+}
+
+void UPuzzleDefinition::PostLoad()
+{
+    Super::PostLoad();
+
+    if(StateDepths.Num() == 0)
+    {
+        Compile();
+    }
+}
+
+#if WITH_EDITOR
+void UPuzzleDefinition::PostEditChangeProperty(FPropertyChangedEvent &PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    Compile();
+}
+#endif
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "LightsOutCore/PuzzleModel.h"
+#include "PuzzleDefinition.generated.h"
+
+// One sequence of gems, by ID, that solves the puzzle.
+USTRUCT()
+struct FPuzzlePattern
+{
+    GENERATED_USTRUCT_BODY()
+
+    UPROPERTY(EditAnywhere, Category = Puzzle)
+    TArray<int32> GemSequence;
+};
+
+/**
+ * Data asset describing a gem puzzle. The accepted patterns are compiled into a flat table with one
+ * transition per state and gem ID, so the puzzle advances with a single lookup per lit gem. Patterns
+ * that start the same way share states and branch where they differ.
+ */
+UCLASS()
+class LIGHTSOUT_API UPuzzleDefinition : public UDataAsset
+{
+    GENERATED_BODY()
+
+    public:
+
+        // Returns the transition for lighting the gem while the puzzle is in the state.
+        uint16 Advance(int32 State, int32 GemId) const
+        {
+            return LightsOutCore::AdvancePuzzle(Transitions.GetData(), NumGems, MismatchTransition, State, GemId);
+        }
+
+        // Number of gems lit in a row to reach the state.
+        int32 GetDepth(int32 State) const { return StateDepths.IsValidIndex(State) ? StateDepths[State] : 0; }
+        int32 GetMaxDepth() const { return MaxDepth; }
+
+        // Builds the transition table from the patterns.
+        void Compile();
+
+        virtual void PreSave() override;
+        virtual void PostLoad() override;
+    #if WITH_EDITOR
+        virtual void PostEditChangeProperty(FPropertyChangedEvent &PropertyChangedEvent) override;
+    #endif
+
+    protected:
+
+        //Sequences of gem IDs that solve the puzzle
+        UPROPERTY(EditAnywhere, Category = Puzzle)
+        TArray<FPuzzlePattern> AcceptedPatterns;
+
+        //When a gem breaks the sequence, it starts a new attempt if a pattern begins with it
+        UPROPERTY(EditAnywhere, Category = Puzzle)
+        bool RestartFromMismatch = false;
+
+    private:
+
+        // Compiled form, saved with the asset so cooked builds never compile at runtime.
+        UPROPERTY()
+        int32 NumGems;
+        UPROPERTY()
+        int32 MaxDepth;
+        UPROPERTY()
+        uint16 MismatchTransition;
+        UPROPERTY()
+        TArray<uint16> Transitions;
+        UPROPERTY()
+        TArray<uint8> StateDepths;
+};
@@ -2,25 +2,33 @@
 
 #include "LightsOut.h"
 #include "PuzzleManager.h"
+#include "PuzzleDefinition.h"
+#include "LightsOutCheckpoint.h"
+#include "LightsOutGameInstance.h"
+#include "Engine/LevelStreaming.h"
 
 
 // Sets default values
 APuzzleManager::APuzzleManager()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Puzzles advance on gem events, so the manager never needs to tick.
+	PrimaryActorTick.bCanEverTick = false;
 }
 
 // Called when the game starts or when spawned
 void APuzzleManager::BeginPlay()
 {
 	Super::BeginPlay();
-}
 
-// Called every frame
-void APuzzleManager::Tick( float DeltaTime )
-{
-	Super::Tick( DeltaTime );
+	PuzzleState = 0;
+
+	// Rooms that are there from the start are restored by the game mode once everything has begun
+	// play, rooms streamed in later pick their progress up here.
+	const FLightsOutCheckpoint *Checkpoint = ULightsOutGameInstance::FindCheckpoint(this);
+	if (Checkpoint && Role == ROLE_Authority && GetWorld()->HasBegunPlay())
+	{
+		Checkpoint->RestorePuzzle(this);
+	}
 }
 
 void APuzzleManager::SpawnPuzzle()
@@ -43,3 +51,51 @@ bool APuzzleManager::CheckIsSolved()
 	return false;
 }
 
+void APuzzleManager::SaveCheckpoint(FPuzzleCheckpoint &Checkpoint) const
+{
+	Checkpoint.PuzzleState = PuzzleState;
+}
+
+void APuzzleManager::RestoreCheckpoint(const FPuzzleCheckpoint &Checkpoint)
+{
+	PuzzleState = Checkpoint.PuzzleState;
+}
+
+uint16 APuzzleManager::AdvancePuzzle(int32 GemId)
+{
+	const uint16 Transition = Definition->Advance(PuzzleState, GemId);
+	PuzzleState = Transition & LightsOutCore::PuzzleStateMask;
+	return Transition;
+}
+
+
+void APuzzleManager::UpdateStreaming(float Progress, bool Solved)
+{
+    // The next room loads hidden while the puzzle is being solved and is shown once the door opens,
+    // so the player never waits on it.
+    if(!NextRoomLevel.IsNone() && (Solved || Progress >= PreloadThreshold))
+    {
+        ULevelStreaming *NextRoom = UGameplayStatics::GetStreamingLevel(this, NextRoomLevel);
+        if(NextRoom)
+        {
+            if(!NextRoom->bShouldBeLoaded)
+            {
+                UE_LOG(LogLightsOut, Log, TEXT("%s started streaming in %s"), *GetName(), *NextRoomLevel.ToString());
+            }
+            NextRoom->bShouldBeLoaded = true;
+            NextRoom->bShouldBeVisible |= Solved;
+        }
+    }
+    
+    // Any progress means the player is in this room, so the one behind them can go.
+    if(!PreviousRoomLevel.IsNone() && (Solved || Progress > 0))
+    {
+        ULevelStreaming *PreviousRoom = UGameplayStatics::GetStreamingLevel(this, PreviousRoomLevel);
+        if(PreviousRoom && PreviousRoom->bShouldBeLoaded)
+        {
+            UE_LOG(LogLightsOut, Log, TEXT("%s started streaming out %s"), *GetName(), *PreviousRoomLevel.ToString());
+            PreviousRoom->bShouldBeLoaded = false;
+            PreviousRoom->bShouldBeVisible = false;
+        }
+    }
+}
@@ -16,13 +16,38 @@ class LIGHTSOUT_API APuzzleManager : public AActor
 
         // Called when the game starts or when spawned
         virtual void BeginPlay() override;
-        
-        // Called every frame
-        virtual void Tick( float DeltaSeconds ) override;
 
         virtual void SpawnPuzzle();
         virtual void OnCompletePuzzle();
         virtual void OnFailPuzzle();
         virtual bool CheckIsSolved();
-	
+    
+        // Copies the puzzle's progress into or out of a checkpoint.
+        virtual void SaveCheckpoint(struct FPuzzleCheckpoint &Checkpoint) const;
+        virtual void RestoreCheckpoint(const struct FPuzzleCheckpoint &Checkpoint);
+
+    protected:
+        // Advances the compiled puzzle by one lit gem and returns the transition taken.
+        uint16 AdvancePuzzle(int32 GemId);
+    
+        // Streams the rooms around this one in and out as the puzzle progresses. Progress runs from 0
+        // to 1 and only ever needs to be reported when it changes.
+        void UpdateStreaming(float Progress, bool Solved);
+
+    protected:
+        //Data driven description of the puzzle, rooms without one use their own rules
+        UPROPERTY(EditAnywhere, Category = Puzzle)
+        class UPuzzleDefinition *Definition;
+    
+        //Sublevel holding the room behind this one's door, loaded in the background as the puzzle nears completion
+        UPROPERTY(EditAnywhere, Category = Streaming)
+        FName NextRoomLevel;
+        //Sublevel holding the room the player came from, unloaded once they start on this puzzle
+        UPROPERTY(EditAnywhere, Category = Streaming)
+        FName PreviousRoomLevel;
+        //Share of the puzzle solved before the next room starts loading
+        UPROPERTY(EditAnywhere, Category = Streaming, meta = (ClampMin = "0", ClampMax = "1"))
+        float PreloadThreshold = 0.5f;
+
+        int32 PuzzleState;
 };
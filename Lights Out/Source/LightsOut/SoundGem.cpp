@@ -3,38 +3,82 @@
 #include "LightsOut.h"
 #include "SoundGem.h"
 #include "Sound/SoundCue.h"
+#include "AudioVoicePool.h"
 #include "FirstRoom.h"
+#include "LightsOutGameInstance.h"
+#include "GemLightBudget.h"
+#include "LightExposureGrid.h"
+#include "GemLightAnimator.h"
 
 
 ASoundGem::ASoundGem()
 {
-    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bCanEverTick = false;
     
     PointLightComponent = CreateDefaultSubobject<UPointLightComponent>(TEXT("PointLight"));
     SetRootComponent(PointLightComponent);
+    GetLightProxy()->AttachTo(PointLightComponent);
 
 	LightColor = FColor(255, 255, 255, 255);
 }
 
+void ASoundGem::PostLoad()
+{
+	Super::PostLoad();
+	
+	ULightsOutGameInstance::MigrateReference(pitch_DEPRECATED, PitchSound);
+	ULightsOutGameInstance::MigrateReference(Fail_DEPRECATED, FailSound);
+	ULightsOutGameInstance::MigrateReference(Win_DEPRECATED, WinSound);
+}
+
 void ASoundGem::BeginPlay()
 {
     Super::BeginPlay();
-	mCurrIntensity = mDefaultIntensity;
-	LerpSpeed = 1000.0f;
-	m_IsShining = false;
-	PointLightComponent->Intensity = mDefaultIntensity;
+	ULightsOutGameInstance::RequestAsyncLoad(this, { PitchSound.ToStringReference(), FailSound.ToStringReference(), WinSound.ToStringReference() });
+	// A checkpoint may already have lit the gem if its room began play first.
+	PointLightComponent->Intensity = m_IsShining ? LightIntensity : mDefaultIntensity;
 	PointLightComponent->SetLightColor(LightColor, true);
+
+	// The gem lights its surroundings for gameplay too, even while the budget only fakes the light.
+	FLightExposureGrid::Get(GetWorld())->Register(PointLightComponent);
+
+	// The budget decides whether the light is rendered for real or faked on the gem's mesh.
+	if (!IsRunningDedicatedServer())
+	{
+		FGemLightBudget::Get(GetWorld())->Register(PointLightComponent, FindComponentByClass<UMeshComponent>());
+	}
 }
 
-void ASoundGem::Tick(float DeltaTime)
+void ASoundGem::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    Super::Tick( DeltaTime );
+	FGemLightBudget *LightBudget = FGemLightBudget::Find(GetWorld());
+	if (LightBudget)
+	{
+		LightBudget->Unregister(PointLightComponent);
+	}
+	FLightExposureGrid *ExposureGrid = FLightExposureGrid::Find(GetWorld());
+	if (ExposureGrid)
+	{
+		ExposureGrid->Unregister(PointLightComponent);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void ASoundGem::RespondToFlashlightHit()
+void ASoundGem::OnBeamEnter(AFlashlight *Flashlight)
 {
-	if (!m_IsShining)
+	DwellTime = 0;
+	HasAttempted = false;
+	OnBeamStay(Flashlight, 0);
+}
+
+// The gem tries to light up once per visit of the beam, after it has been held on it long enough.
+void ASoundGem::OnBeamStay(AFlashlight *Flashlight, float DeltaDwell)
+{
+	DwellTime += DeltaDwell;
+	if (!HasAttempted && !m_IsShining && DwellTime >= RequiredDwellTime)
 	{
+		HasAttempted = true;
 		LightUp();
 	}
 }
@@ -43,17 +87,35 @@ void ASoundGem::LightUp()
 {
 	if (firstroom && firstroom->CheckSequence(this))
 	{
-		PointLightComponent->SetIntensity(LightIntensity);
+		FGemLightAnimator::Get(GetWorld())->Animate(PointLightComponent, LightIntensity, LerpSpeed);
+		m_IsShining = true;
+		GemAudioComponent = PlaySound(PitchSound);
+		firstroom->UpdatePuzzleBits();
+	}
+}
+
+void ASoundGem::SetShining(bool Shining)
+{
+	if (Shining == m_IsShining)
+	{
+		return;
+	}
+	if (Shining)
+	{
+		FGemLightAnimator::Get(GetWorld())->Animate(PointLightComponent, LightIntensity, LerpSpeed);
 		m_IsShining = true;
-		GemAudioComponent = PlaySound(pitch);
+		GemAudioComponent = PlaySound(PitchSound);
+	}
+	else
+	{
+		Reset();
 	}
 }
 
-void ASoundGem::OnShine() 
+void ASoundGem::RestoreShining(bool Shining)
 {
-	mCurrIntensity += LerpSpeed;
-	mCurrIntensity = FMath::Clamp(mCurrIntensity, mDefaultIntensity, LightIntensity);
-	PointLightComponent->Intensity = mCurrIntensity;
+	m_IsShining = Shining;
+	FGemLightAnimator::Get(GetWorld())->Animate(PointLightComponent, Shining ? LightIntensity : mDefaultIntensity, 0);
 }
 
 bool ASoundGem::IsSolved() 
@@ -63,26 +125,27 @@ bool ASoundGem::IsSolved()
 
 void ASoundGem::PlayFailAudio()
 {
-    GemAudioComponent = PlaySound(Fail);
+    GemAudioComponent = PlaySound(FailSound);
 }
 
 void ASoundGem::PlayWinAudio()
 {
-    GemAudioComponent = PlaySound(Win);
+    GemAudioComponent = PlaySound(WinSound);
 }
 
 void ASoundGem::Reset()
 {
-	PointLightComponent->SetIntensity(0);
+	FGemLightAnimator::Get(GetWorld())->Animate(PointLightComponent, mDefaultIntensity, LerpSpeed);
     m_IsShining = false;
 }
 
-UAudioComponent *ASoundGem::PlaySound(USoundCue *Sound)
+UAudioComponent *ASoundGem::PlaySound(const TAssetPtr<USoundCue> &SoundAsset)
 {
+	USoundCue *Sound = ULightsOutGameInstance::Resolve(this, SoundAsset);
 	UAudioComponent *AC = nullptr;
 	if (Sound)
 	{
-		AC = UGameplayStatics::SpawnSoundAttached(Sound, RootComponent);
+		AC = FAudioVoicePool::PlaySoundAttached(Sound, RootComponent);
 	}
 	return AC;
 }
@@ -13,30 +13,44 @@ class LIGHTSOUT_API ASoundGem : public AHittableObject
 	
     public:
         ASoundGem();
+        virtual void PostLoad() override;
         void BeginPlay() override;
-        void Tick( float DeltaSeconds ) override;
-		void RespondToFlashlightHit() override;
+        void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+		void OnBeamEnter(class AFlashlight *Flashlight) override;
+		void OnBeamStay(class AFlashlight *Flashlight, float DeltaDwell) override;
 		void LightUp();
-		void OnShine();
 		bool IsSolved();
 		void Reset();
+		// Shows the gem lit or not without checking the puzzle, for clients following the server.
+		void SetShining(bool Shining);
+		// Sets the gem lit or not at once and silently, for checkpoints.
+		void RestoreShining(bool Shining);
         void PlayFailAudio();
         void PlayWinAudio();
         FColor GetLightColor(){ return LightColor;}
-		class UAudioComponent* PlaySound(class USoundCue *Sound);
+        int32 GetGemId() const { return GemId; }
+		class UAudioComponent* PlaySound(const TAssetPtr<class USoundCue> &SoundAsset);
 
     protected:
 		UPROPERTY(Transient)
 		class UAudioComponent *GemAudioComponent;
 
         UPROPERTY(EditDefaultsOnly, Category = Sound)
-        class USoundCue* pitch;
+        TAssetPtr<class USoundCue> PitchSound;
     
         UPROPERTY(EditDefaultsOnly, Category = Sound)
-        class USoundCue *Fail;
+        TAssetPtr<class USoundCue> FailSound;
     
         UPROPERTY(EditDefaultsOnly, Category = Sound)
-        class USoundCue *Win;
+        TAssetPtr<class USoundCue> WinSound;
+    
+        // Hard references from before the sounds were loaded softly, moved over in PostLoad().
+        UPROPERTY()
+        class USoundCue *pitch_DEPRECATED;
+        UPROPERTY()
+        class USoundCue *Fail_DEPRECATED;
+        UPROPERTY()
+        class USoundCue *Win_DEPRECATED;
     
         UPROPERTY(EditDefaultsOnly, Category = Light)
         UPointLightComponent *PointLightComponent;
@@ -47,8 +61,9 @@ class LIGHTSOUT_API ASoundGem : public AHittableObject
         UPROPERTY(EditDefaultsOnly, Category = Light)
         float LightIntensity = 5000.0f;
        
+        //How fast the light fades in and out, in intensity units per second
         UPROPERTY(EditDefaultsOnly, Category = Light)
-        float LerpSpeed;
+        float LerpSpeed = 10000.0f;
 
 		UPROPERTY(EditDefaultsOnly, Category = Light)
 		float mDefaultIntensity = 0.0f;
@@ -56,12 +71,18 @@ class LIGHTSOUT_API ASoundGem : public AHittableObject
 		UPROPERTY(EditAnywhere)
 		class AFirstRoom* firstroom;
 
-		float TimerRate = 0.1f;
+		//Identifies the gem in its room's puzzle definition
+		UPROPERTY(EditAnywhere, Category = Puzzle)
+		int32 GemId = 0;
+
+		//How long the beam has to rest on the gem before it lights up
+		UPROPERTY(EditAnywhere, Category = Light)
+		float RequiredDwellTime = 0.0f;
 
-		float mCurrIntensity;
+		float DwellTime;
 
-		bool m_IsShining;
+		bool HasAttempted;
 
-		FTimerHandle IntensityTimer;
+		bool m_IsShining = false;
 	
 };